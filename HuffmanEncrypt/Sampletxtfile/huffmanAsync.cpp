@@ -0,0 +1,89 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanAsync.h"
+#include "huffmanBlockCompressor.h"
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+// Compressor của worker đang chạy việc trên luồng này; nullptr ngoài pool
+static thread_local HuffmanBlockCompressor* workerCompressor = nullptr;
+
+HuffmanAsync::HuffmanAsync(int numWorkers, int threadsPerJob, size_t queueCapacity) : jobs(max<size_t>(1, queueCapacity)) {
+    for (int i = 0; i < max(1, numWorkers); i++) {
+        workers.emplace_back([this, threadsPerJob] {
+            HuffmanBlockCompressor compressor;
+            compressor.setThreads(threadsPerJob);
+            workerCompressor = &compressor;
+            coroutine_handle<> job;
+            while (jobs.pop(job)) job.resume();
+            workerCompressor = nullptr;
+        });
+    }
+}
+
+HuffmanAsync::~HuffmanAsync() {
+    jobs.close();
+    for (auto& t : workers) t.join();
+}
+
+AsyncResult HuffmanAsync::run(bool compressMode, const vector<byte>& input, const stop_token& stop) {
+    AsyncResult result;
+    HuffmanBlockCompressor* compressor = workerCompressor;
+    if (!compressor || stop.stop_requested()) {
+        result.status = AsyncStatus::Cancelled;
+        return result;
+    }
+
+    compressor->setStopToken(stop);
+    bool ok;
+    size_t size = 0;
+    // Hết bộ nhớ chỉ làm hỏng việc này, không thoát ra khỏi coroutine của người gọi
+    try {
+        if (compressMode) {
+            result.data.resize(compressor->maxCompressedSize(input.size()));
+            ok = compressor->compress(input, result.data, size);
+        } else {
+            // Kích thước gốc lấy từ header chưa được kiểm tra: giới hạn trước khi cấp phát
+            uint64_t rawSize = 0;
+            ok = HuffmanBlockCompressor::decompressedSize(input, rawSize) && rawSize <= maxOutputSize;
+            if (ok) {
+                result.data.resize(rawSize);
+                ok = compressor->decompress(input, result.data, size);
+            }
+        }
+    } catch (const bad_alloc&) {
+        ok = false;
+    }
+    compressor->setStopToken({});
+
+    if (stop.stop_requested()) {
+        result.status = AsyncStatus::Cancelled;
+        vector<byte>().swap(result.data);
+    } else if (!ok) {
+        vector<byte>().swap(result.data);
+    } else {
+        result.status = AsyncStatus::Ok;
+        result.data.resize(size);
+    }
+    return result;
+}
+
+HuffmanTask<AsyncResult> HuffmanAsync::compressAsync(vector<byte> input, stop_token stop) {
+    AsyncStatus scheduled = co_await ScheduleAwaiter{*this};
+    if (scheduled != AsyncStatus::Ok) co_return AsyncResult{scheduled, {}};
+    AsyncResult result = run(true, input, stop);
+    co_await ResumeAwaiter{resumeExecutor};
+    co_return result;
+}
+
+HuffmanTask<AsyncResult> HuffmanAsync::decompressAsync(vector<byte> input, stop_token stop) {
+    AsyncStatus scheduled = co_await ScheduleAwaiter{*this};
+    if (scheduled != AsyncStatus::Ok) co_return AsyncResult{scheduled, {}};
+    AsyncResult result = run(false, input, stop);
+    co_await ResumeAwaiter{resumeExecutor};
+    co_return result;
+}
@@ -0,0 +1,198 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANASYNC_H
+#define HUFFMANENCRYPT_HUFFMANASYNC_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "huffmanPipeline.h"
+
+// Task kiểu lazy của C++20: coroutine chỉ bắt đầu chạy khi được co_await, khi xong thì chạy tiếp
+// coroutine đang chờ nó (chuyển thẳng, không qua hàng đợi). Chỉ được co_await 1 lần.
+template <typename T>
+class HuffmanTask {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        HuffmanTask get_return_object() { return HuffmanTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_value(T v) { value = std::move(v); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    HuffmanTask(HuffmanTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    HuffmanTask& operator=(HuffmanTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    HuffmanTask(const HuffmanTask&) = delete;
+    HuffmanTask& operator=(const HuffmanTask&) = delete;
+    ~HuffmanTask() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit HuffmanTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+enum class AsyncStatus {
+    Ok,
+    Failed,     // Dữ liệu hỏng / lỗi nén
+    Cancelled,  // stop_token được yêu cầu dừng, hoặc pool đang đóng
+    Busy,       // Hàng đợi việc đã đầy: không xếp hàng (không chặn luồng gọi), gửi lại sau
+};
+
+struct AsyncResult {
+    AsyncStatus status = AsyncStatus::Failed;
+    std::vector<std::byte> data; // Dữ liệu HUFB (nén) hoặc dữ liệu gốc (giải nén)
+};
+
+// API bất đồng bộ cho event loop: công việc chạy trên pool worker nội bộ (mỗi worker giữ 1
+// HuffmanBlockCompressor với buffer dùng lại, như worker của daemon), coroutine gọi được chạy tiếp
+// khi xong thay vì chặn luồng của event loop.
+//
+//   HuffmanTask<AsyncResult> handle(HuffmanAsync& async, std::vector<std::byte> body, std::stop_token stop) {
+//       AsyncResult r = co_await async.compressAsync(std::move(body), stop);
+//       ...
+//   }
+//
+// Mặc định coroutine chạy tiếp ngay trên luồng worker; setResumeExecutor() chuyển nó về luồng của event loop
+// (hàm executor đẩy handle vào hàng đợi của loop rồi loop gọi handle.resume()).
+// Hủy: stop_token được kiểm tra khi worker nhận việc và trước mỗi block; việc bị hủy trả về Cancelled.
+// Việc đã xếp hàng vẫn chờ tới lượt worker nhận rồi mới kết thúc (ngay lập tức, không nén).
+// co_await không bao giờ chặn luồng gọi: hàng đợi đầy thì việc kết thúc ngay với Busy, trên luồng gọi.
+class HuffmanAsync {
+public:
+    using ResumeExecutor = std::function<void(std::coroutine_handle<>)>;
+
+    static const size_t DEFAULT_QUEUE_CAPACITY = 1024;
+    static const uint64_t DEFAULT_MAX_OUTPUT = 1ull << 30;
+
+    // threadsPerJob: số luồng OpenMP của mỗi việc (0 = tự chọn theo kích thước). Nhiều worker cùng lúc
+    // thì nên để 1 luồng mỗi việc để không tranh lõi, như daemon. queueCapacity: số việc chờ tối đa.
+    explicit HuffmanAsync(int workers = 1, int threadsPerJob = 0, size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+    // Chờ các việc đã xếp hàng chạy xong; việc gửi tới sau khi pool đóng trả về Cancelled
+    ~HuffmanAsync();
+    HuffmanAsync(const HuffmanAsync&) = delete;
+    HuffmanAsync& operator=(const HuffmanAsync&) = delete;
+
+    // Gọi trước khi gửi việc (không đồng bộ với các worker đang chạy)
+    void setResumeExecutor(ResumeExecutor executor) { resumeExecutor = std::move(executor); }
+    // Kích thước gốc lớn nhất mà decompressAsync chịu cấp phát; header khai lớn hơn thì trả về Failed.
+    // Gọi trước khi gửi việc.
+    void setMaxOutputSize(uint64_t bytes) { maxOutputSize = bytes; }
+
+    // Cùng định dạng HUFB với API trong bộ nhớ của HuffmanBlockCompressor
+    HuffmanTask<AsyncResult> compressAsync(std::vector<std::byte> input, std::stop_token stop = {});
+    HuffmanTask<AsyncResult> decompressAsync(std::vector<std::byte> input, std::stop_token stop = {});
+
+private:
+    // co_await: chuyển coroutine sang 1 worker của pool. Không chờ chỗ trong hàng đợi: hàng đợi đầy
+    // hoặc pool đã đóng thì chạy tiếp tại chỗ và trả về trạng thái để kết thúc việc.
+    struct ScheduleAwaiter {
+        HuffmanAsync& pool;
+        AsyncStatus status = AsyncStatus::Ok;
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            using Queue = BoundedQueue<std::coroutine_handle<>>;
+            Queue::TryPush pushed = pool.jobs.tryPush(h);
+            if (pushed == Queue::TryPush::Ok) return true;
+            status = pushed == Queue::TryPush::Full ? AsyncStatus::Busy : AsyncStatus::Cancelled;
+            return false;
+        }
+        AsyncStatus await_resume() const noexcept { return status; }
+    };
+
+    // co_await: trả coroutine về executor của người gọi (nếu có)
+    struct ResumeAwaiter {
+        const ResumeExecutor& executor;
+        bool await_ready() const noexcept { return !executor; }
+        void await_suspend(std::coroutine_handle<> h) const { executor(h); }
+        void await_resume() const noexcept {}
+    };
+
+    BoundedQueue<std::coroutine_handle<>> jobs;
+    std::vector<std::thread> workers;
+    ResumeExecutor resumeExecutor;
+    uint64_t maxOutputSize = DEFAULT_MAX_OUTPUT;
+
+    AsyncResult run(bool compressMode, const std::vector<std::byte>& input, const std::stop_token& stop);
+};
+
+// Chặn luồng hiện tại tới khi task xong (cho chương trình không có event loop, hoặc ở main)
+template <typename T>
+T syncWait(HuffmanTask<T> task) {
+    struct Starter {
+        struct promise_type {
+            Starter get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+    std::optional<T> value;
+    std::exception_ptr error;
+    auto start = [&](HuffmanTask<T>& awaited) -> Starter {
+        try {
+            value.emplace(co_await awaited);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+        cv.notify_one();
+    };
+    start(task);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [&] { return done; });
+    if (error) std::rethrow_exception(error);
+    return std::move(*value);
+}
+
+#endif //HUFFMANENCRYPT_HUFFMANASYNC_H
@@ -0,0 +1,883 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanBlock.h"
+#include "huffmanChecksum.h"
+#include "huffmanCpu.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Ghi / đọc số nguyên 32-bit theo thứ tự little-endian (độc lập với máy)
+static inline void writeU32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static inline uint32_t readU32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Đọc 8 byte theo thứ tự big-endian (bit đầu tiên của luồng nằm ở bit cao nhất)
+static inline uint64_t loadBE64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int k = 0; k < 8; k++) v = (v << 8) | p[k];
+    return v;
+}
+
+// Tính độ dài mã Huffman cho từng ký tự, giới hạn ở HUF_MAX_CODE_LEN bit.
+// Không dùng cây Node + priority_queue như các engine cũ để tránh cấp phát động:
+// lá được sắp xếp tăng dần theo tần suất, nút trong sinh ra cũng tăng dần,
+// nên chỉ cần trộn 2 hàng đợi trên mảng cố định.
+void buildCodeLengths(const uint32_t freq[256], uint8_t codeLen[256]) {
+    buildCodeLengths(freq, 256, codeLen);
+}
+
+// Bảng chữ cái tổng quát (tối đa HUF_PAIR_SYMBOLS ký hiệu, dùng cho chế độ cặp byte)
+void buildCodeLengths(const uint32_t* freq, int numSymbols, uint8_t* codeLen) {
+    memset(codeLen, 0, numSymbols);
+
+    int symbols[HUF_PAIR_SYMBOLS];
+    int n = 0;
+    for (int i = 0; i < numSymbols; i++) {
+        if (freq[i] > 0) symbols[n++] = i;
+    }
+    if (n == 0) return;
+    if (n == 1) {
+        // Chỉ có 1 ký tự: vẫn cần mã dài 1 bit để luồng bit giải mã được
+        codeLen[symbols[0]] = 1;
+        return;
+    }
+
+    sort(symbols, symbols + n, [&](int a, int b) {
+        return freq[a] != freq[b] ? freq[a] < freq[b] : a < b;
+    });
+
+    uint64_t weight[2 * HUF_PAIR_SYMBOLS];
+    int parent[2 * HUF_PAIR_SYMBOLS];
+    for (int i = 0; i < n; i++) weight[i] = freq[symbols[i]];
+
+    int leaf = 0, node = n;
+    for (int next = n; next < 2 * n - 1; next++) {
+        int pick[2];
+        for (int k = 0; k < 2; k++) {
+            if (leaf < n && (node >= next || weight[leaf] <= weight[node])) pick[k] = leaf++;
+            else pick[k] = node++;
+        }
+        weight[next] = weight[pick[0]] + weight[pick[1]];
+        parent[pick[0]] = parent[pick[1]] = next;
+    }
+
+    // Độ sâu của từng nút (gốc là nút cuối cùng)
+    int depth[2 * HUF_PAIR_SYMBOLS];
+    depth[2 * n - 2] = 0;
+    for (int i = 2 * n - 3; i >= 0; i--) depth[i] = depth[parent[i]] + 1;
+
+    // Giới hạn độ dài mã: dồn các mã dài hơn giới hạn về HUF_MAX_CODE_LEN
+    // rồi sửa lại bất đẳng thức Kraft bằng cách kéo dài các mã ngắn hơn.
+    int numCodes[HUF_MAX_CODE_LEN + 1] = {0};
+    for (int i = 0; i < n; i++) numCodes[min(depth[i], HUF_MAX_CODE_LEN)]++;
+
+    uint32_t total = 0;
+    for (int len = 1; len <= HUF_MAX_CODE_LEN; len++)
+        total += (uint32_t)numCodes[len] << (HUF_MAX_CODE_LEN - len);
+
+    while (total != (1u << HUF_MAX_CODE_LEN)) {
+        numCodes[HUF_MAX_CODE_LEN]--;
+        for (int len = HUF_MAX_CODE_LEN - 1; len > 0; len--) {
+            if (numCodes[len]) {
+                numCodes[len]--;
+                numCodes[len + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // Gán lại độ dài: ký tự hiếm nhất nhận mã dài nhất
+    int idx = 0;
+    for (int len = HUF_MAX_CODE_LEN; len > 0; len--) {
+        for (int k = 0; k < numCodes[len]; k++) codeLen[symbols[idx++]] = (uint8_t)len;
+    }
+}
+
+// Sinh mã chuẩn tắc: mã tăng dần theo (độ dài, ký hiệu) nên chỉ cần lưu độ dài trong header
+static void assignCanonicalCodes(const uint8_t* codeLen, uint32_t* codes, int numSymbols) {
+    uint32_t code = 0;
+    for (int len = 1; len <= HUF_MAX_CODE_LEN; len++) {
+        for (int s = 0; s < numSymbols; s++) {
+            if (codeLen[s] == len) codes[s] = code++;
+        }
+        code <<= 1;
+    }
+    for (int s = 0; s < numSymbols; s++) {
+        if (codeLen[s] == 0) codes[s] = 0;
+    }
+}
+
+void buildCanonicalCodes(HuffmanTable& table) {
+    assignCanonicalCodes(table.codeLen, table.code, 256);
+}
+
+int specializedCodeLen(int maxLen) {
+    for (int width : HUF_SPECIALIZED_LENS) {
+        if (maxLen <= width) return width;
+    }
+    return HUF_MAX_CODE_LEN;
+}
+
+bool buildDecodeTable(const uint8_t codeLen[256], DecodeTable& table) {
+    HuffmanTable codes;
+    memcpy(codes.codeLen, codeLen, 256);
+    buildCanonicalCodes(codes);
+
+    int maxLen = 0;
+    for (int s = 0; s < 256; s++) maxLen = max(maxLen, (int)codeLen[s]);
+    if (maxLen > HUF_MAX_CODE_LEN) return false;
+
+    // Bảng chỉ rộng bằng cấu hình chuyên biệt nhỏ nhất chứa được mã dài nhất của block
+    table.tableBits = specializedCodeLen(maxLen);
+    const uint32_t tableSize = 1u << table.tableBits;
+    memset(table.entry, 0, (tableSize + 1) * sizeof(table.entry[0]));
+
+    for (int s = 0; s < 256; s++) {
+        int len = codeLen[s];
+        if (len == 0) continue;
+
+        uint32_t first = codes.code[s] << (table.tableBits - len);
+        uint32_t span = 1u << (table.tableBits - len);
+        if (first + span > tableSize) return false; // Bảng mã vượt Kraft -> dữ liệu hỏng
+
+        uint16_t e = (uint16_t)(s | (len << 8));
+        for (uint32_t k = 0; k < span; k++) table.entry[first + k] = e;
+    }
+    return true;
+}
+
+static int streamCountFor(size_t n) {
+    return n >= HUF_MIN_MULTI_STREAM ? HUF_MAX_STREAMS : 1;
+}
+
+static size_t headerSizeFor(int numStreams) {
+    return 1 + 128 + 4 * (size_t)numStreams;
+}
+
+// Block Huffman chỉ được chọn khi nhỏ hơn block stored, nên payload không bao giờ vượt n byte
+size_t maxEncodedBlockSize(size_t n) {
+    return n > 0 ? n : 1;
+}
+
+// Cận trên khi mã hóa bằng bảng mã dựng sẵn (không có histogram của block, mức Fast)
+size_t maxHuffmanBlockSize(size_t n) {
+    return headerSizeFor(HUF_MAX_STREAMS) + (n * HUF_MAX_CODE_LEN + 7) / 8 + HUF_MAX_STREAMS;
+}
+
+void sampleFrequency(const unsigned char* src, size_t n, uint64_t freq[256]) {
+    for (int s = 0; s < 256; s++) freq[s] = 1;
+
+    size_t windows = 1;
+    size_t stride = n;
+    if (n > HUF_SAMPLE_MIN) {
+        size_t sampleBytes = max(HUF_SAMPLE_MIN, n / HUF_SAMPLE_FRACTION);
+        windows = sampleBytes / HUF_SAMPLE_WINDOW;
+        stride = n / windows;
+    }
+    size_t window = windows == 1 ? n : HUF_SAMPLE_WINDOW;
+
+    #pragma omp parallel
+    {
+        uint64_t localFreq[256] = {0};
+
+        #pragma omp for schedule(static)
+        for (long long w = 0; w < (long long)windows; w++) {
+            const unsigned char* p = src + w * stride;
+            for (size_t i = 0; i < window; i++) localFreq[p[i]]++;
+        }
+
+        #pragma omp critical
+        {
+            for (int s = 0; s < 256; s++) freq[s] += localFreq[s];
+        }
+    }
+}
+
+// Kích thước chính xác của payload Huffman: mỗi luồng tốn tổng (tần suất x độ dài mã) bit,
+// làm tròn lên byte
+size_t exactHuffmanBlockSize(const BlockHistogram& hist, const HuffmanTable& table) {
+    size_t size = headerSizeFor(hist.numStreams);
+    for (int j = 0; j < hist.numStreams; j++) {
+        uint64_t bits = 0;
+        for (int s = 0; s < 256; s++) bits += (uint64_t)hist.streamFreq[j][s] * table.codeLen[s];
+        size += (bits + 7) / 8;
+    }
+    return size;
+}
+
+// Kernel đóng gói bit và giải mã vô hướng có 2 bản biên dịch từ cùng 1 thân hàm (luôn inline):
+// bản Generic với cờ mặc định và bản Bmi2 (target bmi2: dịch bit bằng shlx / shrx không đụng cờ).
+// Bản Bmi2 chỉ được gọi khi cpuUse(CPU_BMI2).
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HUF_ALWAYS_INLINE inline __attribute__((always_inline))
+#define HUF_TARGET_BMI2 __attribute__((target("bmi2")))
+#else
+#define HUF_ALWAYS_INLINE inline
+#define HUF_TARGET_BMI2
+#endif
+
+// Bộ ghi bit: tích lũy trong thanh ghi 64-bit, xả 4 byte một lần
+struct BitWriter {
+    unsigned char* out;
+    size_t pos = 0;
+    uint64_t acc = 0;
+    int nbits = 0;
+
+    explicit BitWriter(unsigned char* o) : out(o) {}
+
+    inline void put(uint32_t code, int len) {
+        append(code, len);
+        flush32();
+    }
+
+    // Chỉ thêm bit, không xả: người gọi bảo đảm tổng số bit thêm giữa 2 lần flush32() <= 32
+    inline void append(uint32_t code, int len) {
+        acc = (acc << len) | code;
+        nbits += len;
+    }
+
+    inline void flush32() {
+        if (nbits >= 32) {
+            uint32_t word = (uint32_t)(acc >> (nbits - 32));
+            out[pos] = (unsigned char)(word >> 24);
+            out[pos + 1] = (unsigned char)(word >> 16);
+            out[pos + 2] = (unsigned char)(word >> 8);
+            out[pos + 3] = (unsigned char)word;
+            pos += 4;
+            nbits -= 32;
+        }
+    }
+
+    void flush() {
+        while (nbits >= 8) {
+            nbits -= 8;
+            out[pos++] = (unsigned char)(acc >> nbits);
+        }
+        if (nbits > 0) {
+            out[pos++] = (unsigned char)(acc << (8 - nbits));
+            nbits = 0;
+        }
+    }
+};
+
+// Bộ mã hóa chuyên biệt theo độ dài mã tối đa: sau mỗi lần xả bộ tích lũy còn < 32 bit, nên ghi liền
+// 32 / MaxLen ký tự (hằng số lúc biên dịch, vòng trong được unroll hết) rồi mới cần kiểm tra xả 1 lần.
+template <int MaxLen>
+struct Encoder {
+    static_assert(MaxLen >= 1 && MaxLen <= HUF_MAX_CODE_LEN, "MaxLen ngoai gioi han");
+    static const int SYMBOLS_PER_FLUSH = 32 / MaxLen;
+
+    // Mã hóa 1 luồng (đóng gói bit), trả về số byte đã ghi
+    static HUF_ALWAYS_INLINE size_t encodeStream(const unsigned char* src, size_t n, const HuffmanTable& table,
+                                                 unsigned char* dst) {
+        BitWriter writer(dst);
+        size_t i = 0;
+        for (; i + SYMBOLS_PER_FLUSH <= n; i += SYMBOLS_PER_FLUSH) {
+            for (int k = 0; k < SYMBOLS_PER_FLUSH; k++) {
+                unsigned char c = src[i + k];
+                writer.append(table.code[c], table.codeLen[c]);
+            }
+            writer.flush32();
+        }
+        for (; i < n; i++) {
+            unsigned char c = src[i];
+            writer.put(table.code[c], table.codeLen[c]);
+        }
+        writer.flush();
+        return writer.pos;
+    }
+};
+
+template <int MaxLen>
+static size_t encodeStreamGeneric(const unsigned char* src, size_t n, const HuffmanTable& table, unsigned char* dst) {
+    return Encoder<MaxLen>::encodeStream(src, n, table, dst);
+}
+
+template <int MaxLen>
+HUF_TARGET_BMI2
+static size_t encodeStreamBmi2(const unsigned char* src, size_t n, const HuffmanTable& table, unsigned char* dst) {
+    return Encoder<MaxLen>::encodeStream(src, n, table, dst);
+}
+
+template <int MaxLen>
+static size_t encodeStreams(const unsigned char* src, size_t n, int numStreams, const HuffmanTable& table,
+                            unsigned char* dst) {
+    size_t pos = headerSizeFor(numStreams);
+    size_t segment = (n + numStreams - 1) / numStreams;
+
+    // Mỗi luồng mã hóa một đoạn liên tiếp của block
+    bool bmi2 = cpuUse(CPU_BMI2);
+    for (int j = 0; j < numStreams; j++) {
+        size_t start = min(n, j * segment);
+        size_t end = min(n, start + segment);
+
+        size_t written = bmi2 ? encodeStreamBmi2<MaxLen>(src + start, end - start, table, dst + pos)
+                              : encodeStreamGeneric<MaxLen>(src + start, end - start, table, dst + pos);
+        writeU32(dst + 1 + 128 + 4 * j, (uint32_t)written);
+        pos += written;
+    }
+    return pos;
+}
+
+// ===================== Chế độ ký hiệu 16 bit (cặp byte) =====================
+// Ký hiệu 0..255 là byte đơn, 256 + k là cặp byte hist.pairs[k]. Mỗi luồng được tách thành ký hiệu
+// một cách tham lam (gặp cặp đã chọn thì lấy cả cặp), nên lượt đếm và lượt mã hóa cho cùng kết quả.
+
+struct PairScratch {
+    uint32_t count[65536];  // Số lần gặp mỗi cặp byte liền nhau trong block
+    uint16_t symbol[65536]; // Ký hiệu của cặp đã chọn, 0 = không chọn (luôn được trả về 0 sau khi dùng)
+    vector<uint32_t> candidates;
+};
+
+static PairScratch& pairScratch() {
+    thread_local unique_ptr<PairScratch> scratch;
+    if (!scratch) {
+        scratch.reset(new PairScratch);
+        memset(scratch->symbol, 0, sizeof(scratch->symbol));
+    }
+    return *scratch;
+}
+
+// Gắn ký hiệu cho các cặp đã chọn trong thời gian sống của đối tượng
+struct PairLookup {
+    uint16_t* symbol;
+    const uint16_t* pairs;
+    int numPairs;
+
+    PairLookup(const uint16_t* p, int n) : symbol(pairScratch().symbol), pairs(p), numPairs(n) {
+        for (int k = 0; k < numPairs; k++) symbol[pairs[k]] = (uint16_t)(256 + k);
+    }
+    ~PairLookup() {
+        for (int k = 0; k < numPairs; k++) symbol[pairs[k]] = 0;
+    }
+};
+
+template <typename Emit>
+static inline void tokenizePairs(const unsigned char* src, size_t n, const uint16_t* symbol, Emit emit) {
+    size_t i = 0;
+    while (i + 1 < n) {
+        uint16_t sym = symbol[(src[i] << 8) | src[i + 1]];
+        if (sym) {
+            emit(sym);
+            i += 2;
+        } else {
+            emit(src[i]);
+            i++;
+        }
+    }
+    if (i < n) emit(src[i]);
+}
+
+static size_t pairHeaderSize(int numStreams, int numPairs) {
+    return 1 + 2 + 2 * (size_t)numPairs + (256 + numPairs + 1) / 2 + 4 * (size_t)numStreams;
+}
+
+// Chọn tối đa HUF_MAX_PAIRS cặp hay gặp nhất rồi đếm histogram theo ký hiệu 16 bit của từng luồng
+static void countPairHistogram(const unsigned char* src, size_t n, BlockHistogram& hist) {
+    if (n < 2) return;
+    PairScratch& scratch = pairScratch();
+    memset(scratch.count, 0, sizeof(scratch.count));
+    for (size_t i = 0; i + 1 < n; i++) scratch.count[(src[i] << 8) | src[i + 1]]++;
+
+    vector<uint32_t>& candidates = scratch.candidates;
+    candidates.clear();
+    for (uint32_t pair = 0; pair < 65536; pair++) {
+        if (scratch.count[pair] >= HUF_PAIR_MIN_COUNT) candidates.push_back(pair);
+    }
+    if (candidates.empty()) return;
+
+    // Thứ tự toàn phần (tần suất giảm dần, rồi giá trị cặp) để kết quả không phụ thuộc cài đặt nth_element
+    auto moreFrequent = [&](uint32_t a, uint32_t b) {
+        return scratch.count[a] != scratch.count[b] ? scratch.count[a] > scratch.count[b] : a < b;
+    };
+    if (candidates.size() > (size_t)HUF_MAX_PAIRS) {
+        nth_element(candidates.begin(), candidates.begin() + HUF_MAX_PAIRS, candidates.end(), moreFrequent);
+        candidates.resize(HUF_MAX_PAIRS);
+    }
+    sort(candidates.begin(), candidates.end());
+    hist.numPairs = (int)candidates.size();
+    for (int k = 0; k < hist.numPairs; k++) hist.pairs[k] = (uint16_t)candidates[k];
+
+    int numSymbols = 256 + hist.numPairs;
+    memset(hist.pairFreq, 0, numSymbols * sizeof(uint32_t));
+    PairLookup lookup(hist.pairs, hist.numPairs);
+    size_t segment = (n + hist.numStreams - 1) / hist.numStreams;
+    for (int j = 0; j < hist.numStreams; j++) {
+        uint32_t* f = hist.pairStreamFreq[j];
+        memset(f, 0, numSymbols * sizeof(uint32_t));
+        size_t start = min(n, j * segment);
+        size_t end = min(n, start + segment);
+        tokenizePairs(src + start, end - start, lookup.symbol, [&](uint16_t sym) { f[sym]++; });
+        for (int s = 0; s < numSymbols; s++) hist.pairFreq[s] += f[s];
+    }
+}
+
+static size_t exactPairBlockSize(const BlockHistogram& hist, const PairTable& table) {
+    int numSymbols = 256 + hist.numPairs;
+    size_t size = pairHeaderSize(hist.numStreams, hist.numPairs);
+    for (int j = 0; j < hist.numStreams; j++) {
+        uint64_t bits = 0;
+        for (int s = 0; s < numSymbols; s++) bits += (uint64_t)hist.pairStreamFreq[j][s] * table.codeLen[s];
+        size += (bits + 7) / 8;
+    }
+    return size;
+}
+
+static size_t encodePairBlock(const unsigned char* src, const BlockHistogram& hist, const PairTable& table,
+                              unsigned char* dst) {
+    size_t n = hist.n;
+    int numStreams = hist.numStreams;
+    int numPairs = hist.numPairs;
+    int numSymbols = 256 + numPairs;
+
+    dst[0] = (unsigned char)numStreams;
+    dst[1] = (unsigned char)numPairs;
+    dst[2] = (unsigned char)(numPairs >> 8);
+    unsigned char* p = dst + 3;
+    for (int k = 0; k < numPairs; k++) {
+        *p++ = (unsigned char)(hist.pairs[k] >> 8);
+        *p++ = (unsigned char)hist.pairs[k];
+    }
+    for (int s = 0; s < numSymbols; s += 2) {
+        uint8_t second = s + 1 < numSymbols ? table.codeLen[s + 1] : 0;
+        *p++ = (unsigned char)((table.codeLen[s] << 4) | second);
+    }
+    unsigned char* sizes = p;
+
+    size_t pos = pairHeaderSize(numStreams, numPairs);
+    size_t segment = (n + numStreams - 1) / numStreams;
+    PairLookup lookup(hist.pairs, numPairs);
+    for (int j = 0; j < numStreams; j++) {
+        size_t start = min(n, j * segment);
+        size_t end = min(n, start + segment);
+
+        BitWriter writer(dst + pos);
+        tokenizePairs(src + start, end - start, lookup.symbol,
+                      [&](uint16_t sym) { writer.put(table.code[sym], table.codeLen[sym]); });
+        writer.flush();
+        writeU32(sizes + 4 * j, (uint32_t)writer.pos);
+        pos += writer.pos;
+    }
+    return pos;
+}
+
+// Phần tử bảng giải mã cặp byte: 2 byte ra ở 16 bit thấp, độ dài mã ở bit 16-23, số byte ra ở bit 24-31
+struct PairDecodeTable {
+    uint32_t entry[1 << HUF_TABLE_BITS];
+};
+
+static bool buildPairDecodeTable(const uint8_t* codeLen, const uint16_t* pairs, int numPairs, PairDecodeTable& table) {
+    int numSymbols = 256 + numPairs;
+    uint32_t codes[HUF_PAIR_SYMBOLS];
+    assignCanonicalCodes(codeLen, codes, numSymbols);
+
+    // Phần tử không thuộc mã nào (chỉ gặp khi dữ liệu hỏng): ra 1 byte 0, không tiêu bit
+    const uint32_t tableSize = 1u << HUF_TABLE_BITS;
+    for (uint32_t k = 0; k < tableSize; k++) table.entry[k] = 1u << 24;
+
+    for (int s = 0; s < numSymbols; s++) {
+        int len = codeLen[s];
+        if (len == 0) continue;
+        if (len > HUF_MAX_CODE_LEN) return false;
+
+        uint32_t first = codes[s] << (HUF_TABLE_BITS - len);
+        uint32_t span = 1u << (HUF_TABLE_BITS - len);
+        if (first + span > tableSize) return false;
+
+        uint32_t e = s < 256 ? (uint32_t)s | (1u << 24)
+                             : (uint32_t)(pairs[s - 256] >> 8) | (uint32_t)(pairs[s - 256] & 0xFF) << 8 | (2u << 24);
+        e |= (uint32_t)len << 16;
+        for (uint32_t k = 0; k < span; k++) table.entry[first + k] = e;
+    }
+    return true;
+}
+
+// Giải mã 1 luồng cặp byte: mỗi lần tra ghi luôn 2 byte và tiến 1 hoặc 2 byte, nên đường nhanh
+// chừa đủ chỗ cho 4 ký hiệu x 2 byte. Trả về false nếu 1 cặp byte vượt quá cuối đoạn của luồng.
+static bool decodePairLane(const PairDecodeTable& table, const unsigned char* base, size_t totalBytes,
+                           uint64_t& bitPos, unsigned char* out, size_t count) {
+    const int shift = 64 - HUF_TABLE_BITS;
+    size_t i = 0;
+
+    while (count - i >= 8 && (bitPos >> 3) + 8 <= totalBytes) {
+        uint64_t window = loadBE64(base + (bitPos >> 3)) << (bitPos & 7);
+        int used = 0;
+        for (int k = 0; k < 4; k++) {
+            uint32_t e = table.entry[(window << used) >> shift];
+            out[i] = (unsigned char)e;
+            out[i + 1] = (unsigned char)(e >> 8);
+            i += e >> 24;
+            used += (e >> 16) & 0xFF;
+        }
+        bitPos += used;
+    }
+
+    while (i < count) {
+        size_t byte = bitPos >> 3;
+        uint64_t window = 0;
+        for (int k = 0; k < 8; k++) {
+            window <<= 8;
+            if (byte + k < totalBytes) window |= base[byte + k];
+        }
+        window <<= (bitPos & 7);
+        uint32_t e = table.entry[window >> shift];
+        out[i++] = (unsigned char)e;
+        if ((e >> 24) == 2) {
+            if (i == count) return false;
+            out[i++] = (unsigned char)(e >> 8);
+        }
+        bitPos += (e >> 16) & 0xFF;
+    }
+    return true;
+}
+
+static bool decodePairBlock(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t n) {
+    if (srcSize < 3) return false;
+    int numStreams = src[0];
+    int numPairs = src[1] | (src[2] << 8);
+    if (numStreams < 1 || numStreams > HUF_MAX_STREAMS || numPairs > HUF_MAX_PAIRS) return false;
+
+    size_t header = pairHeaderSize(numStreams, numPairs);
+    if (srcSize < header) return false;
+
+    uint16_t pairs[HUF_MAX_PAIRS];
+    const unsigned char* p = src + 3;
+    for (int k = 0; k < numPairs; k++, p += 2) pairs[k] = (uint16_t)((p[0] << 8) | p[1]);
+    int numSymbols = 256 + numPairs;
+    uint8_t codeLen[HUF_PAIR_SYMBOLS];
+    for (int s = 0; s < numSymbols; s++) codeLen[s] = (s & 1) ? (p[s / 2] & 0x0F) : (p[s / 2] >> 4);
+    const unsigned char* sizes = p + (numSymbols + 1) / 2;
+
+    thread_local unique_ptr<PairDecodeTable> table;
+    if (!table) table.reset(new PairDecodeTable);
+    if (!buildPairDecodeTable(codeLen, pairs, numPairs, *table)) return false;
+
+    const unsigned char* base = src + header;
+    size_t totalBytes = srcSize - header;
+    size_t segment = (n + numStreams - 1) / numStreams;
+    size_t offset = 0;
+    for (int j = 0; j < numStreams; j++) {
+        size_t size = readU32(sizes + 4 * j);
+        size_t start = min(n, j * segment);
+        size_t end = min(n, start + segment);
+        if (offset + size > totalBytes) return false;
+
+        uint64_t bitPos = (uint64_t)offset * 8;
+        if (!decodePairLane(*table, base, totalBytes, bitPos, dst + start, end - start)) return false;
+        // Luồng đọc vượt qua phần của mình nghĩa là dữ liệu hỏng
+        if (bitPos > (uint64_t)(offset + size) * 8) return false;
+        offset += size;
+    }
+    return offset == totalBytes;
+}
+
+void countBlockHistogram(const unsigned char* src, size_t n, BlockHistogram& hist, SymbolMode mode) {
+    hist.n = n;
+    hist.numStreams = streamCountFor(n);
+    hist.checksum = 0;
+    hist.numPairs = 0;
+    memset(hist.freq, 0, sizeof(hist.freq));
+
+    size_t segment = (n + hist.numStreams - 1) / hist.numStreams;
+    for (int j = 0; j < hist.numStreams; j++) {
+        uint32_t* f = hist.streamFreq[j];
+        memset(f, 0, 256 * sizeof(uint32_t));
+        size_t start = min(n, j * segment);
+        size_t end = min(n, start + segment);
+        // Các đoạn liên tiếp nhau nên CRC được nối tiếp qua từng luồng
+        histogramCrc32c(src + start, end - start, f, hist.checksum);
+        for (int s = 0; s < 256; s++) hist.freq[s] += f[s];
+    }
+
+    if (mode == SymbolMode::Pair) countPairHistogram(src, n, hist);
+}
+
+size_t encodeHuffmanBlock(const unsigned char* src, size_t n, const HuffmanTable& table, unsigned char* dst) {
+    int numStreams = streamCountFor(n);
+    dst[0] = (unsigned char)numStreams;
+    for (int i = 0; i < 128; i++)
+        dst[1 + i] = (unsigned char)((table.codeLen[2 * i] << 4) | table.codeLen[2 * i + 1]);
+
+    // Chọn bản chuyên biệt theo mã dài nhất của bảng
+    int maxLen = 0;
+    for (int s = 0; s < 256; s++) maxLen = max(maxLen, (int)table.codeLen[s]);
+    switch (specializedCodeLen(maxLen)) {
+        case 8: return encodeStreams<8>(src, n, numStreams, table, dst);
+        case 10: return encodeStreams<10>(src, n, numStreams, table, dst);
+        default: return encodeStreams<HUF_MAX_CODE_LEN>(src, n, numStreams, table, dst);
+    }
+}
+
+// Bộ giải mã chuyên biệt theo độ rộng bảng tra và độ dài mã tối đa. Đường nhanh đọc 8 byte một lần;
+// sau khi dịch phần lẻ bit còn ít nhất 57 bit hợp lệ nên giải liền 57 / MaxLen ký tự
+// (12 bit: 4 ký tự, 10 bit: 5 ký tự, 8 bit: 7 ký tự) bằng vòng lặp có số lần cố định lúc biên dịch.
+template <int TableBits, int MaxLen>
+struct Decoder {
+    static_assert(MaxLen >= 1 && MaxLen <= TableBits && TableBits <= HUF_TABLE_BITS, "Cau hinh bo giai ma sai");
+    static const int SYMBOLS_PER_LOAD = 57 / MaxLen;
+
+    static HUF_ALWAYS_INLINE void decodeLane(const DecodeTable& table, const unsigned char* base, size_t totalBytes,
+                                             uint64_t& bitPos, unsigned char* out, size_t count) {
+        const int shift = 64 - TableBits;
+        size_t i = 0;
+
+        while (count - i >= SYMBOLS_PER_LOAD && (bitPos >> 3) + 8 <= totalBytes) {
+            uint64_t window = loadBE64(base + (bitPos >> 3)) << (bitPos & 7);
+            int used = 0;
+            for (int k = 0; k < SYMBOLS_PER_LOAD; k++) {
+                uint16_t e = table.entry[(window << used) >> shift];
+                out[i++] = (unsigned char)e;
+                used += e >> 8;
+            }
+            bitPos += used;
+        }
+
+        // Phần đuôi: đọc từng byte, bit ngoài vùng dữ liệu coi như 0
+        while (i < count) {
+            size_t byte = bitPos >> 3;
+            uint64_t window = 0;
+            for (int k = 0; k < 8; k++) {
+                window <<= 8;
+                if (byte + k < totalBytes) window |= base[byte + k];
+            }
+            window <<= (bitPos & 7);
+            uint16_t e = table.entry[window >> shift];
+            out[i++] = (unsigned char)e;
+            bitPos += e >> 8;
+        }
+    }
+};
+
+template <int TableBits, int MaxLen>
+static void decodeLaneGeneric(const DecodeTable& table, const unsigned char* base, size_t totalBytes,
+                              uint64_t& bitPos, unsigned char* out, size_t count) {
+    Decoder<TableBits, MaxLen>::decodeLane(table, base, totalBytes, bitPos, out, count);
+}
+
+template <int TableBits, int MaxLen>
+HUF_TARGET_BMI2
+static void decodeLaneBmi2(const DecodeTable& table, const unsigned char* base, size_t totalBytes,
+                           uint64_t& bitPos, unsigned char* out, size_t count) {
+    Decoder<TableBits, MaxLen>::decodeLane(table, base, totalBytes, bitPos, out, count);
+}
+
+template <int TableBits, int MaxLen>
+static void decodeStreams(const DecodeTable& table, StreamState& state) {
+    bool bmi2 = cpuUse(CPU_BMI2);
+    for (int j = 0; j < state.numStreams; j++) {
+        if (bmi2) {
+            decodeLaneBmi2<TableBits, MaxLen>(table, state.base, state.totalBytes, state.bitPos[j], state.out[j],
+                                              state.count[j]);
+        } else {
+            decodeLaneGeneric<TableBits, MaxLen>(table, state.base, state.totalBytes, state.bitPos[j], state.out[j],
+                                                 state.count[j]);
+        }
+        state.out[j] += state.count[j];
+        state.count[j] = 0;
+    }
+}
+
+// Chọn bản chuyên biệt theo độ rộng bảng (đã xác định từ header block khi dựng bảng)
+void decodeStreamsScalar(const DecodeTable& table, StreamState& state) {
+    switch (table.tableBits) {
+        case 8: decodeStreams<8, 8>(table, state); break;
+        case 10: decodeStreams<10, 10>(table, state); break;
+        default: decodeStreams<HUF_TABLE_BITS, HUF_MAX_CODE_LEN>(table, state); break;
+    }
+}
+
+// Cache bảng giải mã của từng luồng, khóa là 128 byte độ dài mã trong header block.
+// Các block của cùng loại dữ liệu thường ra cùng bộ độ dài mã, nên tra cache (so 128 byte)
+// rẻ hơn nhiều so với dựng lại bảng 4096 phần tử.
+const int HUF_TABLE_CACHE_SIZE = 4;
+
+struct DecodeTableCache {
+    unsigned char key[HUF_TABLE_CACHE_SIZE][128];
+    bool valid[HUF_TABLE_CACHE_SIZE] = {false};
+    DecodeTable table[HUF_TABLE_CACHE_SIZE];
+    int next = 0;
+};
+
+static atomic<uint64_t> tableCacheHits(0), tableCacheMisses(0);
+
+static const DecodeTable* cachedDecodeTable(const unsigned char packedLen[128]) {
+    static thread_local unique_ptr<DecodeTableCache> cache;
+    if (!cache) cache = make_unique<DecodeTableCache>();
+
+    for (int k = 0; k < HUF_TABLE_CACHE_SIZE; k++) {
+        if (cache->valid[k] && memcmp(cache->key[k], packedLen, 128) == 0) {
+            tableCacheHits.fetch_add(1, memory_order_relaxed);
+            return &cache->table[k];
+        }
+    }
+    tableCacheMisses.fetch_add(1, memory_order_relaxed);
+
+    uint8_t codeLen[256];
+    for (int i = 0; i < 128; i++) {
+        codeLen[2 * i] = packedLen[i] >> 4;
+        codeLen[2 * i + 1] = packedLen[i] & 0x0F;
+    }
+    // Thay phần tử cũ nhất (vòng tròn)
+    int slot = cache->next;
+    cache->valid[slot] = false;
+    if (!buildDecodeTable(codeLen, cache->table[slot])) return nullptr;
+    memcpy(cache->key[slot], packedLen, 128);
+    cache->valid[slot] = true;
+    cache->next = (slot + 1) % HUF_TABLE_CACHE_SIZE;
+    return &cache->table[slot];
+}
+
+void decodeTableCacheStats(uint64_t& hits, uint64_t& misses) {
+    hits = tableCacheHits.load();
+    misses = tableCacheMisses.load();
+}
+
+bool decodeHuffmanBlock(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t n,
+                        DecodeKernel kernel) {
+    if (srcSize < 1) return false;
+    int numStreams = src[0];
+    if (numStreams < 1 || numStreams > HUF_MAX_STREAMS) return false;
+
+    size_t header = headerSizeFor(numStreams);
+    if (srcSize < header) return false;
+
+    const DecodeTable* cached = cachedDecodeTable(src + 1);
+    if (!cached) return false;
+    const DecodeTable& table = *cached;
+
+    StreamState state;
+    state.base = src + header;
+    state.totalBytes = srcSize - header;
+    state.numStreams = numStreams;
+
+    size_t segment = (n + numStreams - 1) / numStreams;
+    size_t offset = 0;
+    for (int j = 0; j < numStreams; j++) {
+        size_t size = readU32(src + 1 + 128 + 4 * j);
+        size_t start = min(n, j * segment);
+        size_t end = min(n, start + segment);
+
+        state.bitPos[j] = (uint64_t)offset * 8;
+        state.bitEnd[j] = (uint64_t)(offset + size) * 8;
+        state.out[j] = dst + start;
+        state.count[j] = end - start;
+        offset += size;
+    }
+    if (offset != state.totalBytes) return false;
+
+    if (resolveDecodeKernel(kernel) == DecodeKernel::Avx2) decodeStreamsAvx2(table, state);
+    else decodeStreamsScalar(table, state);
+
+    // Luồng nào đọc vượt qua phần của mình nghĩa là dữ liệu hỏng
+    for (int j = 0; j < numStreams; j++) {
+        if (state.bitPos[j] > state.bitEnd[j]) return false;
+    }
+    return true;
+}
+
+void planBlock(const BlockHistogram& hist, BlockPlan& plan) {
+    int distinct = 0;
+    for (int s = 0; s < 256; s++) distinct += hist.freq[s] > 0;
+
+    if (distinct <= 1) {
+        plan.type = BLOCK_CONSTANT;
+        plan.payloadSize = 1;
+        return;
+    }
+
+    buildCodeLengths(hist.freq, plan.table.codeLen);
+    size_t huffmanSize = exactHuffmanBlockSize(hist, plan.table);
+
+    size_t pairSize = SIZE_MAX;
+    if (hist.numPairs > 0) {
+        buildCodeLengths(hist.pairFreq, 256 + hist.numPairs, plan.pairTable.codeLen);
+        pairSize = exactPairBlockSize(hist, plan.pairTable);
+    }
+
+    if (min(huffmanSize, pairSize) >= hist.n) {
+        // Không lợi gì khi mã hóa (dữ liệu ngẫu nhiên / đã nén): bỏ qua bước mã hóa
+        plan.type = BLOCK_STORED;
+        plan.payloadSize = hist.n;
+        return;
+    }
+
+    if (pairSize < huffmanSize) {
+        assignCanonicalCodes(plan.pairTable.codeLen, plan.pairTable.code, 256 + hist.numPairs);
+        plan.type = BLOCK_PAIRS;
+        plan.payloadSize = pairSize;
+        return;
+    }
+
+    buildCanonicalCodes(plan.table);
+    plan.type = BLOCK_HUFFMAN;
+    plan.payloadSize = huffmanSize;
+}
+
+size_t encodeBlock(const unsigned char* src, const BlockHistogram& hist, const BlockPlan& plan, unsigned char* dst) {
+    switch (plan.type) {
+        case BLOCK_CONSTANT:
+            dst[0] = hist.n > 0 ? src[0] : 0;
+            return 1;
+        case BLOCK_STORED:
+            memcpy(dst, src, hist.n);
+            return hist.n;
+        case BLOCK_PAIRS:
+            return encodePairBlock(src, hist, plan.pairTable, dst);
+        default:
+            return encodeHuffmanBlock(src, hist.n, plan.table, dst);
+    }
+}
+
+bool decodeBlock(BlockType type, const unsigned char* src, size_t srcSize, unsigned char* dst, size_t n,
+                 DecodeKernel kernel) {
+    switch (type) {
+        case BLOCK_HUFFMAN:
+            return decodeHuffmanBlock(src, srcSize, dst, n, kernel);
+        case BLOCK_PAIRS:
+            return decodePairBlock(src, srcSize, dst, n);
+        case BLOCK_STORED:
+            if (srcSize != n) return false;
+            memcpy(dst, src, n);
+            return true;
+        case BLOCK_CONSTANT:
+            if (srcSize != 1) return false;
+            memset(dst, src[0], n);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool cpuHasAvx2() {
+    return cpuUse(CPU_AVX2);
+}
+
+DecodeKernel resolveDecodeKernel(DecodeKernel kernel) {
+    if (kernel == DecodeKernel::Auto) return cpuHasAvx2() ? DecodeKernel::Avx2 : DecodeKernel::Scalar;
+    if (kernel == DecodeKernel::Avx2 && !cpuHasAvx2()) return DecodeKernel::Scalar;
+    return kernel;
+}
+
+const char* decodeKernelName(DecodeKernel kernel) {
+    switch (kernel) {
+        case DecodeKernel::Scalar: return "scalar";
+        case DecodeKernel::Avx2: return "avx2";
+        default: return "auto";
+    }
+}
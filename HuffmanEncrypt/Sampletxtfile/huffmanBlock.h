@@ -0,0 +1,151 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANBLOCK_H
+#define HUFFMANENCRYPT_HUFFMANBLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Định dạng block: mỗi block được nén độc lập bằng bảng mã Huffman chuẩn tắc (canonical),
+// độ dài mã bị giới hạn để giải mã bằng 1 lần tra bảng. Dữ liệu của block được chia thành
+// nhiều luồng bit (stream) độc lập để nhiều bộ đọc bit chạy song song trong cùng một lõi.
+//
+// Payload của block Huffman:
+//   [u8 số luồng][128 byte độ dài mã (4 bit / ký tự)][u32 kích thước mỗi luồng][dữ liệu các luồng]
+//
+// Payload của block cặp byte (ký hiệu 16 bit): bảng chữ cái gồm 256 byte và numPairs cặp byte hay gặp
+// nhất của block, mỗi lần tra bảng giải mã ra tối đa 2 byte:
+//   [u8 số luồng][u16 numPairs][numPairs x 2 byte cặp][độ dài mã 4 bit của 256 + numPairs ký hiệu]
+//   [u32 kích thước mỗi luồng][dữ liệu các luồng]
+
+const int HUF_MAX_CODE_LEN = 12;             // Độ dài mã tối đa (bit)
+const int HUF_TABLE_BITS = HUF_MAX_CODE_LEN; // Bảng giải mã 1 cấp: 2^12 phần tử
+// Các độ dài mã tối đa có bộ mã hóa / giải mã chuyên biệt (bảng tra rộng đúng bằng số bit này)
+const int HUF_SPECIALIZED_LENS[] = {8, 10, HUF_MAX_CODE_LEN};
+const int HUF_MAX_STREAMS = 8;               // 8 luồng = 8 lane 32-bit của thanh ghi AVX2
+const size_t HUF_MIN_MULTI_STREAM = 4096;    // Block nhỏ hơn ngưỡng này chỉ dùng 1 luồng
+
+// Chế độ ký hiệu 16 bit
+const int HUF_MAX_PAIRS = 256;                        // Số cặp byte tối đa trong bảng chữ cái của 1 block
+const int HUF_PAIR_SYMBOLS = 256 + HUF_MAX_PAIRS;
+const uint32_t HUF_PAIR_MIN_COUNT = 8;                // Cặp gặp ít hơn thế không đáng tốn chỗ trong header
+
+// Lấy mẫu histogram cho mức nén Fast
+const size_t HUF_SAMPLE_WINDOW = 4096;       // Kích thước mỗi cửa sổ mẫu
+const size_t HUF_SAMPLE_MIN = 1 << 20;       // Dữ liệu nhỏ hơn ngưỡng này được đếm toàn bộ
+const size_t HUF_SAMPLE_FRACTION = 32;       // Lấy khoảng 1/32 dữ liệu
+
+// Loại block trong file nén
+enum BlockType : uint8_t {
+    BLOCK_HUFFMAN = 0,
+    BLOCK_STORED = 1,   // Dữ liệu không nén được: chép nguyên văn
+    BLOCK_CONSTANT = 2, // Block chỉ có 1 ký tự: payload là 1 byte, giải nén bằng memset
+    BLOCK_PAIRS = 3,    // Block Huffman với ký hiệu 16 bit (byte hoặc cặp byte)
+    BLOCK_END = 0xFF,   // Bản ghi kết thúc: không có dữ liệu, mang checksum của toàn bộ dữ liệu gốc
+};
+
+enum class DecodeKernel { Auto, Scalar, Avx2 };
+
+// Bảng chữ cái khi nén: Byte = 256 ký tự, Pair = thêm các cặp byte hay gặp (block BLOCK_PAIRS
+// chỉ được chọn khi nhỏ hơn block Huffman thường)
+enum class SymbolMode { Byte, Pair };
+
+struct HuffmanTable {
+    uint8_t codeLen[256];
+    uint32_t code[256];
+};
+
+struct PairTable {
+    uint8_t codeLen[HUF_PAIR_SYMBOLS];
+    uint32_t code[HUF_PAIR_SYMBOLS];
+};
+
+// Phần tử bảng giải mã: ký tự ở 8 bit thấp, độ dài mã ở 8 bit cao.
+// Thêm 1 phần tử đệm vì lệnh gather 32-bit đọc 4 byte tại vị trí cuối bảng.
+// Chỉ 2^tableBits + 1 phần tử đầu được dùng (tableBits là 1 trong HUF_SPECIALIZED_LENS).
+struct DecodeTable {
+    int tableBits;
+    uint16_t entry[(1 << HUF_TABLE_BITS) + 1];
+};
+
+// Trạng thái giải mã của các luồng trong một block (dùng chung cho mọi kernel)
+struct StreamState {
+    const unsigned char* base;         // Đầu vùng dữ liệu các luồng (nối liền nhau)
+    size_t totalBytes;                 // Tổng số byte của các luồng
+    int numStreams;
+    uint64_t bitPos[HUF_MAX_STREAMS];  // Vị trí bit hiện tại (tính từ base)
+    uint64_t bitEnd[HUF_MAX_STREAMS];  // Vị trí bit kết thúc của mỗi luồng
+    unsigned char* out[HUF_MAX_STREAMS];
+    size_t count[HUF_MAX_STREAMS];     // Số ký tự còn phải giải mã
+};
+
+// Xây dựng bảng mã
+void buildCodeLengths(const uint32_t freq[256], uint8_t codeLen[256]);
+void buildCodeLengths(const uint32_t* freq, int numSymbols, uint8_t* codeLen);
+void buildCanonicalCodes(HuffmanTable& table);
+bool buildDecodeTable(const uint8_t codeLen[256], DecodeTable& table);
+// Cấu hình chuyên biệt nhỏ nhất chứa được mã dài maxLen bit
+int specializedCodeLen(int maxLen);
+
+// Histogram của block: cả block và từng luồng. Histogram từng luồng cho phép tính
+// chính xác số byte của mỗi luồng (kể cả phần làm tròn byte) mà không cần mã hóa.
+// CRC32C của block được tính trong cùng lượt đọc nên gần như không tốn thêm.
+// Với SymbolMode::Pair còn có các cặp byte được chọn và histogram theo ký hiệu 16 bit.
+struct BlockHistogram {
+    size_t n;
+    int numStreams;
+    uint32_t checksum;
+    uint32_t freq[256];
+    uint32_t streamFreq[HUF_MAX_STREAMS][256];
+
+    int numPairs;                      // 0 = không dùng cặp byte
+    uint16_t pairs[HUF_MAX_PAIRS];     // (byte đầu << 8) | byte sau, tăng dần
+    uint32_t pairFreq[HUF_PAIR_SYMBOLS];
+    uint32_t pairStreamFreq[HUF_MAX_STREAMS][HUF_PAIR_SYMBOLS];
+};
+
+// Kết quả chọn loại block: loại, kích thước payload chính xác và bảng mã (với block Huffman)
+struct BlockPlan {
+    BlockType type;
+    size_t payloadSize;
+    HuffmanTable table;
+    PairTable pairTable; // Với BLOCK_PAIRS
+};
+
+// Mã hóa / giải mã một block
+void countBlockHistogram(const unsigned char* src, size_t n, BlockHistogram& hist,
+                         SymbolMode mode = SymbolMode::Byte);
+size_t maxEncodedBlockSize(size_t n);
+size_t maxHuffmanBlockSize(size_t n);
+size_t exactHuffmanBlockSize(const BlockHistogram& hist, const HuffmanTable& table);
+size_t encodeHuffmanBlock(const unsigned char* src, size_t n, const HuffmanTable& table, unsigned char* dst);
+bool decodeHuffmanBlock(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t n,
+                        DecodeKernel kernel);
+
+// Histogram lấy mẫu theo bước nhảy cố định (các cửa sổ HUF_SAMPLE_WINDOW byte trải đều dữ liệu).
+// Mọi ký tự được cộng thêm 1 để ký tự không xuất hiện trong mẫu vẫn có mã an toàn.
+void sampleFrequency(const unsigned char* src, size_t n, uint64_t freq[256]);
+
+// Chọn loại block (constant / stored / Huffman) từ histogram và tính kích thước payload
+// chính xác, chưa mã hóa gì (dùng cho chế độ dry-run và để cấp phát buffer đúng 1 lần).
+void planBlock(const BlockHistogram& hist, BlockPlan& plan);
+// Ghi payload theo kế hoạch vào dst (đúng plan.payloadSize byte)
+size_t encodeBlock(const unsigned char* src, const BlockHistogram& hist, const BlockPlan& plan, unsigned char* dst);
+bool decodeBlock(BlockType type, const unsigned char* src, size_t srcSize, unsigned char* dst, size_t n,
+                 DecodeKernel kernel);
+
+// Các kernel giải mã. Kernel vô hướng (scalar) là bản tham chiếu,
+// kernel AVX2 phải cho kết quả giống hệt từng bit. Cả 2 chọn bản chuyên biệt theo table.tableBits.
+void decodeStreamsScalar(const DecodeTable& table, StreamState& state);
+void decodeStreamsAvx2(const DecodeTable& table, StreamState& state);
+
+// Số lần tra cache bảng giải mã trúng / trượt (cộng dồn trên mọi luồng)
+void decodeTableCacheStats(uint64_t& hits, uint64_t& misses);
+
+bool cpuHasAvx2();
+DecodeKernel resolveDecodeKernel(DecodeKernel kernel);
+const char* decodeKernelName(DecodeKernel kernel);
+
+#endif //HUFFMANENCRYPT_HUFFMANBLOCK_H
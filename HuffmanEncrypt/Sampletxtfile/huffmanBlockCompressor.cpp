@@ -0,0 +1,989 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanBlockCompressor.h"
+#include "huffmanTuning.h"
+#include "huffmanMemory.h"
+#include "huffmanChecksum.h"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+
+using namespace std;
+using namespace std::chrono;
+
+static void putU32(unsigned char* p, uint32_t v) {
+    for (int k = 0; k < 4; k++) p[k] = (unsigned char)(v >> (8 * k));
+}
+
+static void putU64(unsigned char* p, uint64_t v) {
+    for (int k = 0; k < 8; k++) p[k] = (unsigned char)(v >> (8 * k));
+}
+
+static uint32_t getU32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int k = 3; k >= 0; k--) v = (v << 8) | p[k];
+    return v;
+}
+
+static uint64_t getU64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int k = 7; k >= 0; k--) v = (v << 8) | p[k];
+    return v;
+}
+
+// Đọc / ghi file qua backend I/O đã chọn (io_uring nếu có, nếu không thì pread / pwrite)
+bool HuffmanBlockCompressor::readWholeFile(const string& path, string& content) const {
+    unique_ptr<IoBackend> io = createIoBackend(ioKind);
+    return readFileAsync(*io, path, content);
+}
+
+bool HuffmanBlockCompressor::writeWholeFile(const string& path, const vector<IoSlice>& slices) const {
+    unique_ptr<IoBackend> io = createIoBackend(ioKind);
+    return writeFileAsync(*io, path, slices);
+}
+
+void HuffmanBlockCompressor::setBlockSize(size_t size) {
+    blockSize = min(max(size, (size_t)HUF_MIN_MULTI_STREAM), HUFB_MAX_BLOCK_SIZE);
+}
+
+// Kernel của engine block cho mô hình chi phí: histogram, chọn loại block và mã hóa từng block mặc định
+static size_t blockTuneKernel(const unsigned char* data, size_t n) {
+    vector<unsigned char> payload(HUFB_DEFAULT_BLOCK_SIZE);
+    size_t total = 0;
+    for (size_t offset = 0; offset < n; offset += HUFB_DEFAULT_BLOCK_SIZE) {
+        size_t len = min(HUFB_DEFAULT_BLOCK_SIZE, n - offset);
+        BlockHistogram hist;
+        BlockPlan plan;
+        countBlockHistogram(data + offset, len, hist, SymbolMode::Byte);
+        planBlock(hist, plan);
+        encodeBlock(data + offset, hist, plan, payload.data());
+        total += plan.payloadSize;
+    }
+    return total;
+}
+
+static const TuneEngine TUNE_ENGINE_BLOCK = {"block", blockTuneKernel};
+
+// Số luồng: theo --threads nếu có, nếu không thì theo mô hình chi phí đã hiệu chỉnh của máy cho engine block.
+// Không dùng nhiều luồng hơn số block.
+int HuffmanBlockCompressor::chooseThreads(size_t bytes) const {
+    size_t blocks = max<size_t>(1, (bytes + blockSize - 1) / blockSize);
+    int threads = threadOverride > 0 ? threadOverride : ParallelTuner::instance(TUNE_ENGINE_BLOCK).plan(bytes).threads;
+    return (int)min<size_t>(threads, blocks);
+}
+
+// Bộ nhớ của 1 job trong pipeline: block đầu vào + bản ghi đã nén (không lớn hơn block + header)
+static size_t jobFootprint(size_t blockBytes) {
+    return 2 * blockBytes + HUFB_BLOCK_HEADER_SIZE;
+}
+
+// Chế độ đọc toàn bộ file giữ cả input lẫn output trong RAM
+bool HuffmanBlockCompressor::fitsInMemory(size_t inputBytes, size_t outputBytes) const {
+    return maxMemory == 0 || inputBytes + outputBytes <= maxMemory;
+}
+
+// Pipeline cần ít nhất 4 job (1 worker): nếu ngân sách quá nhỏ cho block hiện tại thì thu nhỏ block
+void HuffmanBlockCompressor::fitBlockSizeToBudget() {
+    if (maxMemory == 0 || 4 * jobFootprint(blockSize) <= maxMemory) return;
+    // Ngân sách dưới mức tối thiểu (CLI đã từ chối): dùng block nhỏ nhất thay vì để phép trừ bị tràn
+    if (maxMemory < HUFB_MIN_MEMORY_BUDGET) {
+        setBlockSize(HUF_MIN_MULTI_STREAM);
+        return;
+    }
+    setBlockSize((maxMemory / 4 - HUFB_BLOCK_HEADER_SIZE) / 2);
+}
+
+void writeBlockHeader(unsigned char* p, BlockType type, size_t rawSize, size_t payloadSize, uint32_t checksum) {
+    p[0] = type;
+    putU32(p + 1, (uint32_t)rawSize);
+    putU32(p + 5, (uint32_t)payloadSize);
+    putU32(p + 9, checksum);
+}
+
+void writeEndRecord(unsigned char* p, uint32_t streamChecksum) {
+    writeBlockHeader(p, BLOCK_END, 0, 0, streamChecksum);
+}
+
+// Nén 1 block (mức Exact) thành bản ghi hoàn chỉnh: header block + payload. Trả về CRC32C của block.
+static uint32_t encodeBlockRecord(const unsigned char* src, size_t n, SymbolMode mode, BlockCache* cache,
+                                  vector<unsigned char>& out) {
+    BlockKey key;
+    if (cache) {
+        key = makeBlockKey(src, n, (uint8_t)mode);
+        if (cache->lookup(key, out)) return key.crc;
+    }
+
+    BlockHistogram hist;
+    BlockPlan plan;
+    countBlockHistogram(src, n, hist, mode);
+    planBlock(hist, plan);
+
+    // Kích thước payload đã biết chính xác -> cấp phát buffer đúng 1 lần
+    out.resize(HUFB_BLOCK_HEADER_SIZE + plan.payloadSize);
+    encodeBlock(src, hist, plan, out.data() + HUFB_BLOCK_HEADER_SIZE);
+    writeBlockHeader(out.data(), plan.type, n, plan.payloadSize, hist.checksum);
+    if (cache) cache->insert(key, out.data(), out.size());
+    return hist.checksum;
+}
+
+void writeFileHeader(unsigned char* header, size_t blockSize, uint64_t originalSize) {
+    memset(header, 0, HUFB_HEADER_SIZE);
+    memcpy(header, HUFB_MAGIC, 4);
+    header[4] = HUFB_VERSION;
+    putU32(header + 8, (uint32_t)blockSize);
+    putU64(header + 12, originalSize);
+}
+
+static void printSummary(size_t total, size_t compressedSize) {
+    cout << "\n--- KET QUA ---" << endl;
+    cout << "Kich thuoc goc:     " << total << " bytes" << endl;
+    cout << "Kich thuoc sau nen: " << compressedSize << " bytes" << endl;
+    double ratio = total > 0 ? (1.0 - (double)compressedSize / total) * 100 : 0;
+    cout << "Ty le nen: " << fixed << setprecision(2) << ratio << "%" << endl;
+    cout << "----------------------------------------------" << endl;
+}
+
+void HuffmanBlockCompressor::encodeBlocksExact(const unsigned char* src, size_t total,
+                                               vector<vector<unsigned char>>& encoded) {
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+    for (long long b = 0; b < (long long)encoded.size(); b++) {
+        size_t offset = b * blockSize;
+        encodeBlockRecord(src + offset, min(blockSize, total - offset), symbolMode, cache, encoded[b]);
+    }
+}
+
+// Mức Fast: 1 bảng mã chung dựng từ mẫu, mỗi block được mã hóa ngay trong 1 lượt
+// (không đếm histogram từng block)
+void HuffmanBlockCompressor::encodeBlocksFast(const unsigned char* src, size_t total,
+                                              vector<vector<unsigned char>>& encoded) {
+    uint64_t sampled[256];
+    sampleFrequency(src, total, sampled);
+    uint32_t freq[256];
+    for (int s = 0; s < 256; s++) freq[s] = (uint32_t)min<uint64_t>(sampled[s], UINT32_MAX);
+
+    HuffmanTable table;
+    buildCodeLengths(freq, table.codeLen);
+    buildCanonicalCodes(table);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+    for (long long b = 0; b < (long long)encoded.size(); b++) {
+        size_t offset = b * blockSize;
+        size_t n = min(blockSize, total - offset);
+        // Mức Fast không đếm histogram từng block nên tính CRC32C riêng (lệnh SSE4.2, rất nhanh)
+        encodeSharedTableRecord(src + offset, n, table, crc32c(0, src + offset, n), encoded[b]);
+    }
+}
+
+void encodeSharedTableRecord(const unsigned char* src, size_t n, const HuffmanTable& table, uint32_t checksum,
+                             vector<unsigned char>& out) {
+    out.resize(HUFB_BLOCK_HEADER_SIZE + maxHuffmanBlockSize(n));
+    size_t size = encodeHuffmanBlock(src, n, table, out.data() + HUFB_BLOCK_HEADER_SIZE);
+
+    BlockType type = BLOCK_HUFFMAN;
+    if (size >= n) {
+        // Bảng mã chung không hợp với block này: lưu nguyên văn
+        type = BLOCK_STORED;
+        size = n;
+        memcpy(out.data() + HUFB_BLOCK_HEADER_SIZE, src, n);
+    }
+    writeBlockHeader(out.data(), type, n, size, checksum);
+    out.resize(HUFB_BLOCK_HEADER_SIZE + size);
+}
+
+// Ghi không qua buffer trung gian (mức Exact): lượt 1 tính kích thước chính xác của từng block
+// (histogram + bảng mã, không mã hóa), cộng dồn thành vị trí trong file; file output được cấp phát
+// đúng kích thước và ánh xạ vào bộ nhớ; lượt 2 mỗi luồng nén block thẳng vào vị trí của nó.
+// Lượt 2 đếm lại histogram thay vì giữ histogram của mọi block trong RAM.
+size_t HuffmanBlockCompressor::planBlockOffsets(const unsigned char* src, size_t total) {
+    size_t numBlocks = (total + blockSize - 1) / blockSize;
+    blockOffset.assign(numBlocks + 1, 0);
+    blockChecksum.resize(numBlocks);
+    if (cache) {
+        blockKeys.resize(numBlocks);
+        cachedRecords.resize(numBlocks);
+    }
+
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+    for (long long b = 0; b < (long long)numBlocks; b++) {
+        if (stopToken.stop_requested()) continue;
+        size_t offset = b * blockSize;
+        if (cache) {
+            // Trúng cache: kích thước bản ghi đã biết, lượt 2 chỉ chép bản ghi vào vị trí
+            blockKeys[b] = makeBlockKey(src + offset, min(blockSize, total - offset), (uint8_t)symbolMode);
+            if (cache->lookup(blockKeys[b], cachedRecords[b])) {
+                blockOffset[b + 1] = cachedRecords[b].size();
+                blockChecksum[b] = blockKeys[b].crc;
+                continue;
+            }
+        }
+        BlockHistogram hist;
+        BlockPlan plan;
+        countBlockHistogram(src + offset, min(blockSize, total - offset), hist, symbolMode);
+        planBlock(hist, plan);
+        blockOffset[b + 1] = HUFB_BLOCK_HEADER_SIZE + plan.payloadSize;
+        blockChecksum[b] = hist.checksum;
+    }
+    blockOffset[0] = HUFB_HEADER_SIZE;
+    plannedChecksum = 0;
+    for (size_t b = 0; b < numBlocks; b++) {
+        blockOffset[b + 1] += blockOffset[b];
+        plannedChecksum = crc32cCombine(plannedChecksum, blockChecksum[b], min(blockSize, total - b * blockSize));
+    }
+    return blockOffset[numBlocks] + HUFB_BLOCK_HEADER_SIZE;
+}
+
+// Lượt 2 đếm lại histogram thay vì giữ histogram của mọi block trong RAM
+void HuffmanBlockCompressor::encodeAtOffsets(const unsigned char* src, size_t total, unsigned char* dst) {
+    size_t numBlocks = blockOffset.size() - 1;
+    writeFileHeader(dst, blockSize, total);
+    writeEndRecord(dst + blockOffset[numBlocks], plannedChecksum);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+    for (long long b = 0; b < (long long)numBlocks; b++) {
+        if (stopToken.stop_requested()) continue;
+        size_t offset = b * blockSize;
+        size_t n = min(blockSize, total - offset);
+        unsigned char* record = dst + blockOffset[b];
+        if (cache && !cachedRecords[b].empty()) {
+            memcpy(record, cachedRecords[b].data(), cachedRecords[b].size());
+            vector<unsigned char>().swap(cachedRecords[b]);
+            continue;
+        }
+
+        BlockHistogram hist;
+        BlockPlan plan;
+        countBlockHistogram(src + offset, n, hist, symbolMode);
+        planBlock(hist, plan);
+
+        encodeBlock(src + offset, hist, plan, record + HUFB_BLOCK_HEADER_SIZE);
+        writeBlockHeader(record, plan.type, n, plan.payloadSize, hist.checksum);
+        if (cache) cache->insert(blockKeys[b], record, HUFB_BLOCK_HEADER_SIZE + plan.payloadSize);
+    }
+}
+
+// Ghi không qua buffer trung gian (mức Exact): tính vị trí chính xác của từng block, cấp phát file output
+// đúng kích thước, ánh xạ vào bộ nhớ rồi nén thẳng vào đó
+bool HuffmanBlockCompressor::encodeBlocksMapped(const unsigned char* src, size_t total, const string& outputPath,
+                                                size_t& compressedSize) {
+    compressedSize = planBlockOffsets(src, total);
+    MappedOutputFile out;
+    if (!out.create(outputPath, compressedSize)) return false;
+    encodeAtOffsets(src, total, out.data());
+    return out.close();
+}
+
+bool HuffmanBlockCompressor::compress(const string& inputFilePath, const string& outputFilePath) {
+    // File không vừa ngân sách bộ nhớ (input + output trong RAM): nén theo pipeline
+    error_code ec;
+    uintmax_t inputSize = filesystem::file_size(inputFilePath, ec);
+    if (!ec && !fitsInMemory(inputSize, inputSize + HUFB_HEADER_SIZE)) {
+        cout << "File input vuot ngan sach bo nho (" << formatMemorySize(maxMemory) << "): chuyen sang pipeline" << endl;
+        return runPipeline(inputFilePath, outputFilePath, true);
+    }
+
+    cout << "--- BAT DAU QUA TRINH NEN HUFFMAN (BLOCK - DA LUONG BIT) ---" << endl;
+    cout << "Muc nen: " << (level == CompressionLevel::Fast ? "fast (histogram lay mau)" : "exact") << endl;
+    if (symbolMode == SymbolMode::Pair) {
+        // Mức Fast dùng 1 bảng mã byte chung cho mọi block nên không có cặp byte riêng của block
+        cout << "Ky hieu: 16 bit (byte + cap byte)" << (level == CompressionLevel::Fast ? " - bo qua o muc fast" : "") << endl;
+    }
+    // Mức Fast mã hóa mọi block bằng 1 bảng mã chung nên bản ghi phụ thuộc cả file, không cache theo block được
+    if (cache && level == CompressionLevel::Fast) cout << "Cache block chi dung o muc exact - bo qua" << endl;
+    cout << "Input:  " << inputFilePath << endl;
+    cout << "Output: " << outputFilePath << endl;
+    cout << "Backend I/O: " << createIoBackend(ioKind)->name() << endl << endl;
+
+    // --- BƯỚC 1: ĐỌC FILE ---
+    auto start = high_resolution_clock::now();
+    string content;
+    if (!readWholeFile(inputFilePath, content)) {
+        cerr << "Loi: Khong the mo file input!" << endl;
+        return false;
+    }
+    auto end = high_resolution_clock::now();
+    cout << "[1] Doc file vao RAM: " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+
+    // --- BƯỚC 2: NÉN TỪNG BLOCK (SONG SONG) ---
+    size_t total = content.size();
+    size_t numBlocks = (total + blockSize - 1) / blockSize;
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(content.data());
+    numThreads = chooseThreads(total);
+    size_t compressedSize = 0;
+
+    if (outputMode == OutputMode::Mmap && level == CompressionLevel::Fast) {
+        // Mức Fast không đếm histogram từng block nên không biết trước kích thước: ghi như thường
+        cout << "Mmap chi ho tro muc exact, dung che do ghi thuong" << endl;
+    } else if (outputMode == OutputMode::Mmap) {
+        start = high_resolution_clock::now();
+        if (!encodeBlocksMapped(src, total, outputFilePath, compressedSize)) {
+            cerr << "Loi: Khong the ghi file output (mmap)!" << endl;
+            return false;
+        }
+        end = high_resolution_clock::now();
+        cout << "[2] Nen " << numBlocks << " block thang vao file anh xa (mmap, " << numThreads << " luong): "
+             << duration_cast<microseconds>(end - start).count() << " us" << endl;
+        printSummary(total, compressedSize);
+        if (cache) cout << cache->report();
+        return true;
+    }
+
+    vector<vector<unsigned char>> encoded(numBlocks);
+    start = high_resolution_clock::now();
+
+    if (level == CompressionLevel::Fast) encodeBlocksFast(src, total, encoded);
+    else encodeBlocksExact(src, total, encoded);
+    end = high_resolution_clock::now();
+    cout << "[2] Nen " << numBlocks << " block (" << numThreads << " luong): "
+         << duration_cast<microseconds>(end - start).count() << " us" << endl;
+
+    // --- BƯỚC 3: GHI FILE ---
+    start = high_resolution_clock::now();
+    unsigned char header[HUFB_HEADER_SIZE];
+    writeFileHeader(header, blockSize, total);
+
+    // Header và các block được ghi liền nhau, nhiều yêu cầu ghi chạy đồng thời
+    vector<IoSlice> slices;
+    slices.push_back({header, HUFB_HEADER_SIZE});
+    compressedSize = HUFB_HEADER_SIZE;
+    uint32_t streamChecksum = 0;
+    for (size_t b = 0; b < numBlocks; b++) {
+        slices.push_back({encoded[b].data(), encoded[b].size()});
+        compressedSize += encoded[b].size();
+        streamChecksum = crc32cCombine(streamChecksum, getU32(encoded[b].data() + 9), min(blockSize, total - b * blockSize));
+    }
+    unsigned char endRecord[HUFB_BLOCK_HEADER_SIZE];
+    writeEndRecord(endRecord, streamChecksum);
+    slices.push_back({endRecord, HUFB_BLOCK_HEADER_SIZE});
+    compressedSize += HUFB_BLOCK_HEADER_SIZE;
+    if (!writeWholeFile(outputFilePath, slices)) {
+        cerr << "Loi: Khong the ghi file output!" << endl;
+        return false;
+    }
+    end = high_resolution_clock::now();
+    cout << "[3] Ghi file Output: " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+
+    printSummary(total, compressedSize);
+    if (cache && level == CompressionLevel::Exact) cout << cache->report();
+    return true;
+}
+
+bool HuffmanBlockCompressor::estimate(const string& inputFilePath, uint64_t& compressedSize) {
+    cout << "--- UOC LUONG KICH THUOC NEN (DRY-RUN) ---" << endl;
+    cout << "Input:  " << inputFilePath << endl << endl;
+
+    auto start = high_resolution_clock::now();
+    string content;
+    if (!readWholeFile(inputFilePath, content)) {
+        cerr << "Loi: Khong the mo file input!" << endl;
+        return false;
+    }
+
+    size_t total = content.size();
+    size_t numBlocks = (total + blockSize - 1) / blockSize;
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(content.data());
+    numThreads = chooseThreads(total);
+    uint64_t payloadTotal = 0;
+    long long typeCount[4] = {0, 0, 0, 0};
+
+    // Chỉ đếm histogram và dựng bảng mã cho từng block, không mã hóa
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1) reduction(+:payloadTotal) reduction(+:typeCount[:4])
+    for (long long b = 0; b < (long long)numBlocks; b++) {
+        size_t offset = b * blockSize;
+        size_t n = min(blockSize, total - offset);
+
+        BlockHistogram hist;
+        BlockPlan plan;
+        countBlockHistogram(src + offset, n, hist, symbolMode);
+        planBlock(hist, plan);
+
+        payloadTotal += HUFB_BLOCK_HEADER_SIZE + plan.payloadSize;
+        typeCount[plan.type]++;
+    }
+    compressedSize = HUFB_HEADER_SIZE + payloadTotal + HUFB_BLOCK_HEADER_SIZE; // + bản ghi kết thúc
+    auto end = high_resolution_clock::now();
+
+    cout << "Thoi gian uoc luong: " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    cout << "So block (Huffman / Cap byte / Stored / Constant): " << typeCount[BLOCK_HUFFMAN] << " / "
+         << typeCount[BLOCK_PAIRS] << " / " << typeCount[BLOCK_STORED] << " / " << typeCount[BLOCK_CONSTANT] << endl;
+    cout << "Kich thuoc goc:     " << total << " bytes" << endl;
+    cout << "Kich thuoc sau nen: " << compressedSize << " bytes (chinh xac)" << endl;
+    double ratio = total > 0 ? (1.0 - (double)compressedSize / total) * 100 : 0;
+    cout << "Ty le nen: " << fixed << setprecision(2) << ratio << "%" << endl;
+    cout << "----------------------------------------------" << endl;
+    return true;
+}
+
+// quiet: không in lỗi (API trong bộ nhớ chỉ báo lỗi bằng giá trị trả về)
+static bool indexBlocks(const unsigned char* data, size_t size, BlockIndex& index, bool quiet = false) {
+    auto fail = [quiet](const char* message) {
+        if (!quiet) cerr << message << endl;
+        return false;
+    };
+    if (size < HUFB_HEADER_SIZE || memcmp(data, HUFB_MAGIC, 4) != 0 ||
+        (data[4] != HUFB_VERSION && data[4] != HUFB_VERSION_NO_CHECKSUM)) {
+        return fail("Loi: File khong dung dinh dang HUFB!");
+    }
+    index.blocks.clear();
+    index.hasChecksum = data[4] == HUFB_VERSION;
+    size_t recordHeader = index.hasChecksum ? HUFB_BLOCK_HEADER_SIZE : HUFB_V1_BLOCK_HEADER_SIZE;
+    uint64_t originalSize = getU64(data + 12);
+
+    size_t pos = HUFB_HEADER_SIZE;
+    uint64_t produced = 0;
+    bool ended = false;
+    while (pos < size) {
+        if (size - pos < recordHeader) {
+            return fail("Loi: Header block bi cat cut!");
+        }
+        BlockRef ref;
+        ref.type = data[pos];
+        ref.rawSize = getU32(data + pos + 1);
+        ref.payloadSize = getU32(data + pos + 5);
+        ref.checksum = index.hasChecksum ? getU32(data + pos + 9) : 0;
+        ref.srcOffset = pos + recordHeader;
+        ref.dstOffset = produced;
+
+        if (index.hasChecksum && ref.type == BLOCK_END) {
+            // Bản ghi kết thúc phải là bản ghi cuối cùng
+            if (ref.rawSize != 0 || ref.payloadSize != 0 || ref.srcOffset != size) {
+                return fail("Loi: Ban ghi ket thuc khong hop le!");
+            }
+            index.streamChecksum = ref.checksum;
+            ended = true;
+            break;
+        }
+        if (ref.payloadSize > size - ref.srcOffset) {
+            return fail("Loi: Block bi cat cut!");
+        }
+        index.blocks.push_back(ref);
+        produced += ref.rawSize;
+        pos = ref.srcOffset + ref.payloadSize;
+    }
+    if (index.hasChecksum && !ended) {
+        return fail("Loi: Thieu ban ghi ket thuc (file bi cat cut)!");
+    }
+    // File nén từ stdin không biết trước kích thước gốc
+    if (originalSize == HUFB_UNKNOWN_SIZE) originalSize = produced;
+    if (produced != originalSize) {
+        return fail("Loi: Tong kich thuoc block khong khop header!");
+    }
+    index.originalSize = originalSize;
+    return true;
+}
+
+// Checksum toàn bộ dữ liệu ghép từ checksum các block (các block đã được kiểm tra riêng)
+static bool verifyStreamChecksum(const BlockIndex& index) {
+    if (!index.hasChecksum) return true;
+    uint32_t crc = 0;
+    for (const BlockRef& ref : index.blocks) crc = crc32cCombine(crc, ref.checksum, ref.rawSize);
+    return crc == index.streamChecksum;
+}
+
+// Giải mã song song mọi block vào dst, kiểm tra checksum từng block và toàn bộ dữ liệu
+bool HuffmanBlockCompressor::decodeIndexed(const unsigned char* data, const BlockIndex& index, unsigned char* dst) {
+    const vector<BlockRef>& blocks = index.blocks;
+    bool hasChecksum = index.hasChecksum;
+    bool ok = true;
+
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1) reduction(&&:ok)
+    for (long long b = 0; b < (long long)blocks.size(); b++) {
+        if (stopToken.stop_requested()) {
+            ok = false;
+            continue;
+        }
+        const BlockRef& ref = blocks[b];
+        bool blockOk = decodeBlock((BlockType)ref.type, data + ref.srcOffset, ref.payloadSize,
+                                   dst + ref.dstOffset, ref.rawSize, kernel);
+        // Kiểm tra ngay khi block vừa giải mã còn nằm trong cache
+        if (blockOk && hasChecksum) blockOk = crc32c(0, dst + ref.dstOffset, ref.rawSize) == ref.checksum;
+        ok = ok && blockOk;
+    }
+    return ok && verifyStreamChecksum(index);
+}
+
+bool HuffmanBlockCompressor::decompress(const string& inputFilePath, const string& outputFilePath) {
+    // Kích thước gốc nằm trong header: kiểm tra ngân sách bộ nhớ trước khi đọc cả file
+    if (maxMemory > 0) {
+        ifstream probe(inputFilePath, ios::binary);
+        unsigned char header[HUFB_HEADER_SIZE];
+        if (probe.read(reinterpret_cast<char*>(header), HUFB_HEADER_SIZE)) {
+            error_code ec;
+            uintmax_t packedSize = filesystem::file_size(inputFilePath, ec);
+            uint64_t originalSize = getU64(header + 12);
+            if (!ec && (originalSize == HUFB_UNKNOWN_SIZE || !fitsInMemory(packedSize, originalSize))) {
+                cout << "File vuot ngan sach bo nho (" << formatMemorySize(maxMemory) << "): chuyen sang pipeline" << endl;
+                return runPipeline(inputFilePath, outputFilePath, false);
+            }
+        }
+    }
+
+    cout << "--- BAT DAU QUA TRINH GIAI NEN HUFFMAN (BLOCK) ---" << endl;
+    cout << "Kernel giai ma: " << decodeKernelName(resolveDecodeKernel(kernel)) << endl;
+    cout << "Backend I/O: " << createIoBackend(ioKind)->name() << endl;
+
+    // --- BƯỚC 1: ĐỌC FILE NÉN VÀ LẬP CHỈ MỤC BLOCK ---
+    auto start = high_resolution_clock::now();
+    string packed;
+    if (!readWholeFile(inputFilePath, packed)) {
+        cerr << "Loi: Khong the mo file input!" << endl;
+        return false;
+    }
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(packed.data());
+    BlockIndex index;
+    if (!indexBlocks(data, packed.size(), index)) return false;
+    const vector<BlockRef>& blocks = index.blocks;
+    uint64_t originalSize = index.originalSize;
+    auto end = high_resolution_clock::now();
+    cout << "[1] Doc file & lap chi muc " << blocks.size() << " block: "
+         << duration_cast<microseconds>(end - start).count() << " us" << endl;
+
+    // --- BƯỚC 2: GIẢI MÃ CÁC BLOCK (SONG SONG) ---
+    numThreads = chooseThreads(originalSize);
+    start = high_resolution_clock::now();
+    string output;
+    output.resize(originalSize);
+    unsigned char* dst = reinterpret_cast<unsigned char*>(&output[0]);
+    bool ok = decodeIndexed(data, index, dst);
+    end = high_resolution_clock::now();
+    if (!ok) {
+        cerr << "Loi: Du lieu nen bi hong (sai checksum)!" << endl;
+        return false;
+    }
+    double seconds = duration_cast<microseconds>(end - start).count() / 1e6;
+    cout << "[2] Giai ma & kiem tra checksum (" << numThreads << " luong): " << duration_cast<microseconds>(end - start).count() << " us";
+    if (seconds > 0) cout << " (" << fixed << setprecision(1) << originalSize / seconds / 1e6 << " MB/s)";
+    cout << endl;
+    if (!index.hasChecksum) cout << "    File version 1: khong co checksum" << endl;
+
+    // --- BƯỚC 3: GHI FILE ---
+    start = high_resolution_clock::now();
+    if (!writeWholeFile(outputFilePath, {{output.data(), output.size()}})) {
+        cerr << "Loi: Khong the ghi file output!" << endl;
+        return false;
+    }
+    end = high_resolution_clock::now();
+    cout << "[3] Ghi file Output: " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    cout << "----------------------------------------------" << endl;
+    return true;
+}
+
+// Giải mã từng block vào buffer tạm của luồng (kích thước 1 block) rồi bỏ đi:
+// bộ nhớ chỉ gồm file nén + số luồng x block, không có bản sao dữ liệu gốc
+bool HuffmanBlockCompressor::test(const string& inputFilePath) {
+    cout << "--- KIEM TRA FILE NEN (TEST) ---" << endl;
+    cout << "Input: " << inputFilePath << endl;
+
+    auto start = high_resolution_clock::now();
+    string packed;
+    if (!readWholeFile(inputFilePath, packed)) {
+        cerr << "Loi: Khong the mo file input!" << endl;
+        return false;
+    }
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(packed.data());
+    BlockIndex index;
+    if (!indexBlocks(data, packed.size(), index)) return false;
+    const vector<BlockRef>& blocks = index.blocks;
+    bool hasChecksum = index.hasChecksum;
+
+    numThreads = chooseThreads(index.originalSize);
+    long long badBlocks = 0;
+    long long firstBad = -1;
+
+    #pragma omp parallel num_threads(numThreads) if(numThreads > 1) reduction(+:badBlocks)
+    {
+        vector<unsigned char> scratch;
+
+        #pragma omp for schedule(dynamic)
+        for (long long b = 0; b < (long long)blocks.size(); b++) {
+            const BlockRef& ref = blocks[b];
+            if (scratch.size() < ref.rawSize) scratch.resize(ref.rawSize);
+            bool blockOk = decodeBlock((BlockType)ref.type, data + ref.srcOffset, ref.payloadSize,
+                                       scratch.data(), ref.rawSize, kernel);
+            if (blockOk && hasChecksum) blockOk = crc32c(0, scratch.data(), ref.rawSize) == ref.checksum;
+            if (!blockOk) {
+                badBlocks++;
+                #pragma omp critical
+                {
+                    if (firstBad < 0 || b < firstBad) firstBad = b;
+                }
+            }
+        }
+    }
+    bool streamOk = verifyStreamChecksum(index);
+    auto end = high_resolution_clock::now();
+
+    double seconds = duration_cast<microseconds>(end - start).count() / 1e6;
+    cout << "So block: " << blocks.size() << ", du lieu goc: " << index.originalSize << " bytes" << endl;
+    cout << "Thoi gian: " << duration_cast<microseconds>(end - start).count() << " us (" << numThreads << " luong)";
+    if (seconds > 0) cout << " (" << fixed << setprecision(1) << index.originalSize / seconds / 1e6 << " MB/s)";
+    cout << endl;
+    if (!hasChecksum) cout << "File version 1: khong co checksum, chi kiem tra giai ma duoc" << endl;
+
+    if (badBlocks > 0) {
+        cerr << "Loi: " << badBlocks << " block bi hong (block dau tien: " << firstBad << ")" << endl;
+        return false;
+    }
+    if (!streamOk) {
+        cerr << "Loi: Checksum toan bo du lieu khong khop!" << endl;
+        return false;
+    }
+    cout << "OK: File nen toan ven" << endl;
+    cout << "----------------------------------------------" << endl;
+    return true;
+}
+
+// ===================== PIPELINE (đọc / mã hóa / ghi chồng lấp) =====================
+// Luồng đọc lấy job rỗng từ pool, đọc 1 block vào job rồi đẩy vào hàng đợi công việc;
+// các worker mã hóa song song; luồng ghi (luồng gọi hàm) sắp lại đúng thứ tự index và ghi ra.
+// Vì mọi công đoạn chạy đồng thời, thời gian tổng tiến tới max(I/O, CPU) thay vì tổng của chúng.
+
+// Số worker theo số luồng, giảm bớt nếu pool (2 x worker + 2 job) vượt ngân sách bộ nhớ
+int HuffmanBlockCompressor::pipelineWorkers(size_t blockBytes) const {
+    int workers = threadOverride > 0 ? threadOverride : max(1, omp_get_max_threads());
+    if (maxMemory > 0) {
+        size_t maxJobs = maxMemory / jobFootprint(blockBytes);
+        workers = (int)min<size_t>(workers, maxJobs >= 4 ? (maxJobs - 2) / 2 : 1);
+    }
+    return workers;
+}
+
+static void printPoolInfo(int workers, size_t poolSize, size_t blockBytes) {
+    cerr << "Worker: " << workers << ", pool: " << poolSize << " job x block " << blockBytes << " bytes (~"
+         << formatMemorySize(poolSize * jobFootprint(blockBytes)) << ")" << endl;
+}
+
+// Luồng ghi: nhận job đã xử lý (có thể lệch thứ tự), ghi theo đúng index rồi trả job về pool.
+// Checksum các block được ghép theo đúng thứ tự thành checksum của toàn bộ dữ liệu gốc.
+static bool writeInOrder(BoundedQueue<PipelineJob*>& doneQueue, BoundedQueue<PipelineJob*>& freeQueue,
+                         ostream& out, uint64_t& written, uint32_t& streamChecksum) {
+    map<size_t, PipelineJob*> pending;
+    size_t nextIndex = 0;
+    bool ok = true;
+    PipelineJob* job;
+
+    while (doneQueue.pop(job)) {
+        pending[job->index] = job;
+        while (!pending.empty() && pending.begin()->first == nextIndex) {
+            PipelineJob* ready = pending.begin()->second;
+            pending.erase(pending.begin());
+            if (!ready->ok) ok = false;
+            if (ok) {
+                out.write(reinterpret_cast<const char*>(ready->output.data()), ready->output.size());
+                written += ready->output.size();
+                streamChecksum = crc32cCombine(streamChecksum, ready->checksum, ready->rawSize);
+                if (!out) ok = false;
+            }
+            nextIndex++;
+            freeQueue.push(ready);
+        }
+        if (!ok) break;
+    }
+    return ok;
+}
+
+bool HuffmanBlockCompressor::compressStream(istream& in, ostream& out, uint64_t& rawBytes, uint64_t& packedBytes) {
+    fitBlockSizeToBudget();
+    int workers = pipelineWorkers(blockSize);
+    size_t poolSize = 2 * workers + 2;
+    printPoolInfo(workers, poolSize, blockSize);
+    vector<PipelineJob> pool(poolSize);
+    BoundedQueue<PipelineJob*> freeQueue(poolSize), workQueue(poolSize), doneQueue(poolSize);
+    for (auto& job : pool) freeQueue.push(&job);
+
+    unsigned char header[HUFB_HEADER_SIZE];
+    writeFileHeader(header, blockSize, HUFB_UNKNOWN_SIZE);
+    out.write(reinterpret_cast<char*>(header), HUFB_HEADER_SIZE);
+    packedBytes = HUFB_HEADER_SIZE;
+
+    atomic<uint64_t> totalRead(0);
+    thread reader([&] {
+        PipelineJob* job;
+        size_t index = 0;
+        while (freeQueue.pop(job)) {
+            job->input.resize(blockSize);
+            in.read(reinterpret_cast<char*>(job->input.data()), blockSize);
+            size_t n = (size_t)in.gcount();
+            if (n == 0) break;
+            job->input.resize(n);
+            job->rawSize = n;
+            job->index = index++;
+            job->ok = true;
+            totalRead += n;
+            if (!workQueue.push(job)) break;
+        }
+        workQueue.close();
+    });
+
+    vector<thread> encoders;
+    atomic<int> running(workers);
+    for (int w = 0; w < workers; w++) {
+        encoders.emplace_back([&] {
+            PipelineJob* job;
+            while (workQueue.pop(job)) {
+                job->checksum = encodeBlockRecord(job->input.data(), job->input.size(), symbolMode, cache, job->output);
+                doneQueue.push(job);
+            }
+            if (--running == 0) doneQueue.close();
+        });
+    }
+
+    uint32_t streamChecksum = 0;
+    bool ok = writeInOrder(doneQueue, freeQueue, out, packedBytes, streamChecksum);
+    if (ok) {
+        unsigned char endRecord[HUFB_BLOCK_HEADER_SIZE];
+        writeEndRecord(endRecord, streamChecksum);
+        out.write(reinterpret_cast<char*>(endRecord), HUFB_BLOCK_HEADER_SIZE);
+        packedBytes += HUFB_BLOCK_HEADER_SIZE;
+        ok = (bool)out;
+    }
+
+    // Lỗi ghi: đóng mọi hàng đợi để các luồng khác thoát ra
+    freeQueue.close();
+    workQueue.close();
+    doneQueue.close();
+    reader.join();
+    for (auto& t : encoders) t.join();
+
+    rawBytes = totalRead;
+    return ok && !in.bad();
+}
+
+bool HuffmanBlockCompressor::decompressStream(istream& in, ostream& out, uint64_t& rawBytes) {
+    unsigned char header[HUFB_HEADER_SIZE];
+    in.read(reinterpret_cast<char*>(header), HUFB_HEADER_SIZE);
+    if ((size_t)in.gcount() != HUFB_HEADER_SIZE || memcmp(header, HUFB_MAGIC, 4) != 0 ||
+        (header[4] != HUFB_VERSION && header[4] != HUFB_VERSION_NO_CHECKSUM)) {
+        cerr << "Loi: File khong dung dinh dang HUFB!" << endl;
+        return false;
+    }
+    uint64_t originalSize = getU64(header + 12);
+    bool hasChecksum = header[4] == HUFB_VERSION;
+    size_t recordHeader = hasChecksum ? HUFB_BLOCK_HEADER_SIZE : HUFB_V1_BLOCK_HEADER_SIZE;
+    size_t fileBlockSize = min<size_t>(getU32(header + 8), HUFB_MAX_BLOCK_SIZE);
+
+    int workers = pipelineWorkers(fileBlockSize);
+    size_t poolSize = 2 * workers + 2;
+    printPoolInfo(workers, poolSize, fileBlockSize);
+    vector<PipelineJob> pool(poolSize);
+    BoundedQueue<PipelineJob*> freeQueue(poolSize), workQueue(poolSize), doneQueue(poolSize);
+    for (auto& job : pool) freeQueue.push(&job);
+
+    atomic<bool> truncated(false);
+    bool ended = false;
+    uint32_t expectedChecksum = 0;
+    thread reader([&] {
+        PipelineJob* job;
+        size_t index = 0;
+        unsigned char blockHeader[HUFB_BLOCK_HEADER_SIZE];
+        while (freeQueue.pop(job)) {
+            in.read(reinterpret_cast<char*>(blockHeader), recordHeader);
+            size_t got = (size_t)in.gcount();
+            if (got == 0) break;
+
+            job->index = index++;
+            job->type = (BlockType)blockHeader[0];
+            job->rawSize = getU32(blockHeader + 1);
+            size_t payloadSize = getU32(blockHeader + 5);
+            job->checksum = hasChecksum ? getU32(blockHeader + 9) : 0;
+            if (hasChecksum && got == recordHeader && job->type == BLOCK_END) {
+                ended = job->rawSize == 0 && payloadSize == 0;
+                expectedChecksum = job->checksum;
+                if (!ended) truncated = true;
+                break;
+            }
+            // Payload không bao giờ lớn hơn block gốc: chặn cấp phát bất thường từ dữ liệu hỏng
+            bool sane = got == recordHeader && job->rawSize <= HUFB_MAX_BLOCK_SIZE &&
+                        payloadSize <= max<size_t>(job->rawSize, 1);
+            if (sane) {
+                job->input.resize(payloadSize);
+                in.read(reinterpret_cast<char*>(job->input.data()), payloadSize);
+                sane = (size_t)in.gcount() == payloadSize;
+            }
+            job->ok = sane;
+            if (!sane) truncated = true;
+            if (!workQueue.push(job) || !sane) break;
+        }
+        workQueue.close();
+    });
+
+    vector<thread> decoders;
+    atomic<int> running(workers);
+    for (int w = 0; w < workers; w++) {
+        decoders.emplace_back([&] {
+            PipelineJob* job;
+            while (workQueue.pop(job)) {
+                if (job->ok) {
+                    job->output.resize(job->rawSize);
+                    job->ok = decodeBlock(job->type, job->input.data(), job->input.size(),
+                                          job->output.data(), job->rawSize, kernel);
+                    if (job->ok && hasChecksum) job->ok = crc32c(0, job->output.data(), job->rawSize) == job->checksum;
+                }
+                doneQueue.push(job);
+            }
+            if (--running == 0) doneQueue.close();
+        });
+    }
+
+    rawBytes = 0;
+    uint32_t streamChecksum = 0;
+    bool ok = writeInOrder(doneQueue, freeQueue, out, rawBytes, streamChecksum);
+
+    freeQueue.close();
+    workQueue.close();
+    doneQueue.close();
+    reader.join();
+    for (auto& t : decoders) t.join();
+
+    if (!ok || truncated || (hasChecksum && !ended)) {
+        cerr << "Loi: Du lieu nen bi hong hoac bi cat cut!" << endl;
+        return false;
+    }
+    if (hasChecksum && streamChecksum != expectedChecksum) {
+        cerr << "Loi: Checksum toan bo du lieu khong khop!" << endl;
+        return false;
+    }
+    if (originalSize != HUFB_UNKNOWN_SIZE && rawBytes != originalSize) {
+        cerr << "Loi: Tong kich thuoc block khong khop header!" << endl;
+        return false;
+    }
+    return true;
+}
+
+// "-" nghĩa là stdin / stdout. Khi ghi ra stdout, mọi thông báo đi qua cerr.
+bool HuffmanBlockCompressor::runPipeline(const string& inputPath, const string& outputPath, bool compressMode) {
+    bool useStdin = inputPath == "-";
+    bool useStdout = outputPath == "-";
+
+    ifstream inFile;
+    if (!useStdin) {
+        inFile.open(inputPath, ios::binary);
+        if (!inFile) {
+            cerr << "Loi: Khong the mo file input!" << endl;
+            return false;
+        }
+    }
+    ofstream outFile;
+    if (!useStdout) {
+        outFile.open(outputPath, ios::binary);
+        if (!outFile) {
+            cerr << "Loi: Khong the tao file output!" << endl;
+            return false;
+        }
+    }
+    istream& in = useStdin ? cin : static_cast<istream&>(inFile);
+    ostream& out = useStdout ? cout : static_cast<ostream&>(outFile);
+
+    cerr << "--- PIPELINE " << (compressMode ? "NEN" : "GIAI NEN") << " HUFFMAN (doc / xu ly / ghi song song) ---" << endl;
+    if (maxMemory > 0) cerr << "Ngan sach bo nho: " << formatMemorySize(maxMemory) << endl;
+    auto start = high_resolution_clock::now();
+
+    uint64_t rawBytes = 0, packedBytes = 0;
+    bool ok;
+    if (compressMode) {
+        ok = compressStream(in, out, rawBytes, packedBytes);
+        // Ghi ra file thì quay lại điền kích thước gốc vào header
+        if (ok && !useStdout) {
+            unsigned char size[8];
+            putU64(size, rawBytes);
+            outFile.seekp(12);
+            outFile.write(reinterpret_cast<char*>(size), 8);
+        }
+    } else {
+        ok = decompressStream(in, out, rawBytes);
+    }
+    out.flush();
+
+    auto end = high_resolution_clock::now();
+    double seconds = duration_cast<microseconds>(end - start).count() / 1e6;
+    if (ok) {
+        cerr << "Du lieu goc: " << rawBytes << " bytes";
+        if (compressMode) cerr << ", sau nen: " << packedBytes << " bytes";
+        cerr << endl << "Thoi gian: " << duration_cast<microseconds>(end - start).count() << " us";
+        if (seconds > 0) cerr << " (" << fixed << setprecision(1) << rawBytes / seconds / 1e6 << " MB/s)";
+        cerr << endl;
+        if (compressMode && cache) cerr << cache->report();
+    }
+    return ok;
+}
+
+bool HuffmanBlockCompressor::compressPipelined(const string& inputFilePath, const string& outputFilePath) {
+    return runPipeline(inputFilePath, outputFilePath, true);
+}
+
+bool HuffmanBlockCompressor::decompressPipelined(const string& inputFilePath, const string& outputFilePath) {
+    return runPipeline(inputFilePath, outputFilePath, false);
+}
+
+// ===================== API TRONG BỘ NHỚ =====================
+
+size_t HuffmanBlockCompressor::maxCompressedSize(size_t n) const {
+    size_t numBlocks = (n + blockSize - 1) / blockSize;
+    // Payload của mỗi block không lớn hơn dữ liệu gốc của nó (block stored)
+    return HUFB_HEADER_SIZE + numBlocks * HUFB_BLOCK_HEADER_SIZE + n + HUFB_BLOCK_HEADER_SIZE;
+}
+
+bool HuffmanBlockCompressor::compress(span<const byte> input, span<byte> output, size_t& compressedSize) {
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(input.data());
+    unsigned char* dst = reinterpret_cast<unsigned char*>(output.data());
+    size_t total = input.size();
+    numThreads = chooseThreads(total);
+
+    if (numThreads > 1) {
+        compressedSize = planBlockOffsets(src, total);
+        if (compressedSize > output.size() || stopToken.stop_requested()) return false;
+        encodeAtOffsets(src, total, dst);
+        return !stopToken.stop_requested();
+    }
+
+    // Payload nhỏ: 1 lượt tuần tự, nén từng block ngay tại vị trí ghi, không cần bảng vị trí
+    if (output.size() < HUFB_HEADER_SIZE) return false;
+    writeFileHeader(dst, blockSize, total);
+    size_t pos = HUFB_HEADER_SIZE;
+    uint32_t streamChecksum = 0;
+    for (size_t offset = 0; offset < total; offset += blockSize) {
+        if (stopToken.stop_requested()) return false;
+        size_t n = min(blockSize, total - offset);
+        BlockHistogram hist;
+        BlockPlan plan;
+        countBlockHistogram(src + offset, n, hist, symbolMode);
+        planBlock(hist, plan);
+        if (output.size() - pos < 2 * HUFB_BLOCK_HEADER_SIZE + plan.payloadSize) return false;
+
+        encodeBlock(src + offset, hist, plan, dst + pos + HUFB_BLOCK_HEADER_SIZE);
+        writeBlockHeader(dst + pos, plan.type, n, plan.payloadSize, hist.checksum);
+        pos += HUFB_BLOCK_HEADER_SIZE + plan.payloadSize;
+        streamChecksum = crc32cCombine(streamChecksum, hist.checksum, n);
+    }
+    if (output.size() - pos < HUFB_BLOCK_HEADER_SIZE) return false;
+    writeEndRecord(dst + pos, streamChecksum);
+    compressedSize = pos + HUFB_BLOCK_HEADER_SIZE;
+    return true;
+}
+
+bool HuffmanBlockCompressor::decompressedSize(span<const byte> input, uint64_t& size) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data());
+    if (input.size() < HUFB_HEADER_SIZE || memcmp(data, HUFB_MAGIC, 4) != 0 ||
+        (data[4] != HUFB_VERSION && data[4] != HUFB_VERSION_NO_CHECKSUM))
+        return false;
+    size = getU64(data + 12);
+    return size != HUFB_UNKNOWN_SIZE;
+}
+
+bool HuffmanBlockCompressor::decompress(span<const byte> input, span<byte> output, size_t& decompressedSize) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data());
+    if (!indexBlocks(data, input.size(), scratchIndex, true)) return false;
+    if (scratchIndex.originalSize > output.size()) return false;
+
+    numThreads = chooseThreads(scratchIndex.originalSize);
+    if (!decodeIndexed(data, scratchIndex, reinterpret_cast<unsigned char*>(output.data()))) return false;
+    decompressedSize = scratchIndex.originalSize;
+    return true;
+}
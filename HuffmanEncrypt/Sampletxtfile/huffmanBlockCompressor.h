@@ -0,0 +1,159 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANBLOCKCOMPRESSOR_H
+#define HUFFMANENCRYPT_HUFFMANBLOCKCOMPRESSOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <stop_token>
+#include <omp.h>
+#include "huffmanBlock.h"
+#include "huffmanCommon.h"
+#include "huffmanPipeline.h"
+#include "huffmanIo.h"
+#include "huffmanCache.h"
+
+// Định dạng file (.huff dạng block):
+//   Header: "HUFB" | u8 version | 3 byte dự trữ | u32 blockSize | u64 originalSize
+//   Mỗi block: u8 loại | u32 rawSize | u32 payloadSize | u32 CRC32C(dữ liệu gốc của block) | payload
+//   Kết thúc: bản ghi BLOCK_END (rawSize = payloadSize = 0), trường CRC32C là checksum của toàn bộ dữ liệu gốc
+// File version 1 (không có checksum, header block 9 byte, không có bản ghi kết thúc) vẫn giải nén được.
+const char HUFB_MAGIC[4] = {'H', 'U', 'F', 'B'};
+const uint8_t HUFB_VERSION = 2;
+const uint8_t HUFB_VERSION_NO_CHECKSUM = 1;
+const size_t HUFB_HEADER_SIZE = 20;
+const size_t HUFB_BLOCK_HEADER_SIZE = 13;
+const size_t HUFB_V1_BLOCK_HEADER_SIZE = 9;
+const size_t HUFB_DEFAULT_BLOCK_SIZE = 128 * 1024;
+const size_t HUFB_MAX_BLOCK_SIZE = 16 * 1024 * 1024; // Giữ vị trí bit của block trong int32 (kernel AVX2)
+const uint64_t HUFB_UNKNOWN_SIZE = UINT64_MAX;       // originalSize khi nén từ stdin ra stdout
+// Ngân sách bộ nhớ nhỏ nhất: pipeline 4 job (input + bản ghi nén) với block nhỏ nhất
+const size_t HUFB_MIN_MEMORY_BUDGET = 4 * (2 * HUF_MIN_MULTI_STREAM + HUFB_BLOCK_HEADER_SIZE);
+
+// Ghi header file / header block / bản ghi kết thúc (mang CRC32C của toàn bộ dữ liệu gốc)
+void writeFileHeader(unsigned char* header, size_t blockSize, uint64_t originalSize);
+void writeBlockHeader(unsigned char* p, BlockType type, size_t rawSize, size_t payloadSize, uint32_t checksum);
+void writeEndRecord(unsigned char* p, uint32_t streamChecksum);
+// Bản ghi block mã hóa bằng bảng mã dùng chung cho nhiều block (mức Fast, chế độ MPI);
+// block mà bảng mã làm phình ra được lưu nguyên văn
+void encodeSharedTableRecord(const unsigned char* src, size_t n, const HuffmanTable& table, uint32_t checksum,
+                             std::vector<unsigned char>& out);
+
+// Chỉ mục các block của một file / buffer nén nằm trọn trong RAM
+struct BlockRef {
+    size_t srcOffset, payloadSize, dstOffset, rawSize;
+    uint32_t checksum;
+    uint8_t type;
+};
+
+struct BlockIndex {
+    std::vector<BlockRef> blocks;
+    uint64_t originalSize = 0;
+    bool hasChecksum = false;      // File version 2
+    uint32_t streamChecksum = 0;   // Lấy từ bản ghi kết thúc
+};
+
+class HuffmanBlockCompressor {
+private:
+    size_t blockSize;
+    DecodeKernel kernel;
+    CompressionLevel level;
+    int threadOverride;     // 0 = tự chọn theo mô hình chi phí
+    int numThreads;         // Số luồng của lần chạy hiện tại
+    IoBackendKind ioKind;
+    OutputMode outputMode;
+    size_t maxMemory;       // Ngân sách bộ nhớ (byte), 0 = không giới hạn
+    SymbolMode symbolMode;
+    BlockCache* cache;      // Không sở hữu; nullptr = không dùng cache
+    std::stop_token stopToken; // Yêu cầu hủy: các vòng block bỏ qua block còn lại, API trong bộ nhớ trả về false
+
+    int chooseThreads(size_t bytes) const;
+    int pipelineWorkers(size_t blockBytes) const;
+    bool fitsInMemory(size_t inputBytes, size_t outputBytes) const;
+    void fitBlockSizeToBudget();
+    bool readWholeFile(const std::string& path, std::string& content) const;
+    bool writeWholeFile(const std::string& path, const std::vector<IoSlice>& slices) const;
+    bool runPipeline(const std::string& inputPath, const std::string& outputPath, bool compressMode);
+    void encodeBlocksExact(const unsigned char* src, size_t total, std::vector<std::vector<unsigned char>>& encoded);
+    void encodeBlocksFast(const unsigned char* src, size_t total, std::vector<std::vector<unsigned char>>& encoded);
+    bool encodeBlocksMapped(const unsigned char* src, size_t total, const std::string& outputPath, size_t& compressedSize);
+
+    // Nén 2 lượt vào buffer đích đã cấp phát: lượt 1 tính vị trí chính xác của từng block, lượt 2 nén song song
+    // thẳng vào vị trí đó. Dùng chung cho chế độ mmap và API trong bộ nhớ.
+    size_t planBlockOffsets(const unsigned char* src, size_t total);
+    void encodeAtOffsets(const unsigned char* src, size_t total, unsigned char* dst);
+    bool decodeIndexed(const unsigned char* data, const BlockIndex& index, unsigned char* dst);
+
+    // Buffer dùng lại giữa các lần gọi (chỉ cấp phát khi cần lớn hơn lần trước)
+    std::vector<size_t> blockOffset;
+    std::vector<uint32_t> blockChecksum;
+    std::vector<BlockKey> blockKeys;                     // Khi có cache: khóa của từng block
+    std::vector<std::vector<unsigned char>> cachedRecords; // Bản ghi lấy từ cache ở lượt 1 (rỗng = không trúng)
+    uint32_t plannedChecksum = 0;
+    BlockIndex scratchIndex;
+
+public:
+    HuffmanBlockCompressor()
+        : blockSize(HUFB_DEFAULT_BLOCK_SIZE), kernel(DecodeKernel::Auto), level(CompressionLevel::Exact),
+          threadOverride(0), numThreads(1), ioKind(IoBackendKind::Auto),
+          outputMode(OutputMode::Stream), maxMemory(0), symbolMode(SymbolMode::Byte), cache(nullptr) {}
+
+    void setBlockSize(size_t size);
+    void setDecodeKernel(DecodeKernel k) { kernel = k; }
+    void setLevel(CompressionLevel l) { level = l; }
+    void setThreads(int threads) { threadOverride = threads; }
+    void setIoBackend(IoBackendKind kind) { ioKind = kind; }
+    // Mmap (mức Exact): tính trước vị trí từng block rồi nén thẳng vào file output đã ánh xạ
+    void setOutputMode(OutputMode mode) { outputMode = mode; }
+    // Giới hạn bộ nhớ: file không vừa ngân sách được xử lý theo pipeline, số worker và
+    // kích thước block được chọn sao cho pool job nằm trong ngân sách (tối thiểu HUFB_MIN_MEMORY_BUDGET)
+    void setMaxMemory(size_t bytes) { maxMemory = bytes; }
+    // Pair: block được phép dùng ký hiệu 16 bit (byte + cặp byte hay gặp), mỗi lần tra bảng ra tới 2 byte
+    void setSymbolMode(SymbolMode mode) { symbolMode = mode; }
+    // Cache kết quả theo nội dung block (mức Exact): block trùng nội dung với block đã nén trước đó
+    // dùng lại bản ghi đã mã hóa (kèm bảng mã), bỏ qua histogram và mã hóa
+    void setCache(BlockCache* blockCache) { cache = blockCache; }
+    // Hủy giữa chừng (API bất đồng bộ): kiểm tra trước mỗi block của API trong bộ nhớ
+    void setStopToken(std::stop_token token) { stopToken = std::move(token); }
+
+    // Nén từng block độc lập (song song bằng OpenMP)
+    bool compress(const std::string& inputFilePath, const std::string& outputFilePath);
+    // Dry-run: tính chính xác kích thước file nén và tỉ lệ nén mà không mã hóa / ghi file
+    bool estimate(const std::string& inputFilePath, uint64_t& compressedSize);
+    // Giải nén song song theo block, mỗi block dùng kernel giải mã đã chọn
+    bool decompress(const std::string& inputFilePath, const std::string& outputFilePath);
+    // Kiểm tra file nén: giải mã song song và so checksum từng block + toàn bộ dữ liệu, không ghi output
+    bool test(const std::string& inputFilePath);
+    // Đo riêng từng công đoạn (histogram, dựng bảng mã, mã hóa, ghép bản ghi, ghi file, giải mã), mỗi công đoạn
+    // kèm bộ đếm phần cứng (huffmanPerf.h) nếu hệ thống cho phép
+    bool benchmarkStages(const std::string& inputFilePath, const std::string& outputFilePath);
+
+    // Pipeline kiểu pigz: luồng đọc, các worker và luồng ghi chạy chồng lấp qua hàng đợi có giới hạn.
+    // Đường dẫn "-" dùng stdin / stdout. Bộ nhớ chỉ cỡ (2 x số worker + 2) block.
+    bool compressStream(std::istream& in, std::ostream& out, uint64_t& rawBytes, uint64_t& packedBytes);
+    bool decompressStream(std::istream& in, std::ostream& out, uint64_t& rawBytes);
+    bool compressPipelined(const std::string& inputFilePath, const std::string& outputFilePath);
+    bool decompressPipelined(const std::string& inputFilePath, const std::string& outputFilePath);
+
+    // Chế độ MPI (chạy bằng mpirun): mỗi rank đọc 1 dải block liền nhau của file, histogram được cộng bằng
+    // MPI_Allreduce thành 1 bảng mã chung, mỗi rank mã hóa dải của mình, vị trí ghi là exclusive scan của
+    // kích thước nén và mọi rank cùng ghi (MPI-IO collective) vào 1 file HUFB. Bản build không có MPI trả về false.
+    bool compressMpi(const std::string& inputFilePath, const std::string& outputFilePath);
+
+    // API trong bộ nhớ (không đọc / ghi file, không in log), cùng định dạng HUFB với file.
+    // Ghi vào buffer của người gọi; sau lần gọi đầu không cấp phát thêm nếu kích thước không tăng.
+    // Cận trên kích thước nén của n byte với blockSize hiện tại
+    size_t maxCompressedSize(size_t n) const;
+    bool compress(std::span<const std::byte> input, std::span<std::byte> output, size_t& compressedSize);
+    // Kích thước dữ liệu gốc ghi trong header (để cấp phát buffer giải nén)
+    static bool decompressedSize(std::span<const std::byte> input, uint64_t& size);
+    bool decompress(std::span<const std::byte> input, std::span<std::byte> output, size_t& decompressedSize);
+};
+
+#endif //HUFFMANENCRYPT_HUFFMANBLOCKCOMPRESSOR_H
@@ -0,0 +1,292 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanCache.h"
+#include "huffmanBlock.h"
+#include "huffmanChecksum.h"
+#include "huffmanMemory.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const size_t RECORD_HEADER_SIZE = 13; // Giống HUFB_BLOCK_HEADER_SIZE
+static const size_t TRAILER_SIZE = 8;        // Hash 64 bit của toàn bộ bản ghi, ghi sau bản ghi
+static const char* ENTRY_SUFFIX = ".blk";
+
+// ===================== HASH =====================
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t load64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t hashRound(uint64_t acc, uint64_t input) {
+    return rotl64(acc + input * PRIME2, 31) * PRIME1;
+}
+
+static inline uint64_t hashMerge(uint64_t acc, uint64_t lane) {
+    return (acc ^ hashRound(0, lane)) * PRIME1 + PRIME4;
+}
+
+// Hash kiểu xxHash64: 4 bộ cộng dồn độc lập trên các khối 32 byte (các phép nhân chạy song song trong CPU),
+// rồi trộn phần đuôi. Chỉ dùng làm khóa cache, không cần tương thích với thư viện xxHash.
+uint64_t blockHash64(const unsigned char* data, size_t n, uint64_t seed) {
+    const unsigned char* p = data;
+    const unsigned char* end = data + n;
+    uint64_t h;
+
+    if (n >= 32) {
+        uint64_t v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed, v4 = seed - PRIME1;
+        for (; p + 32 <= end; p += 32) {
+            v1 = hashRound(v1, load64(p));
+            v2 = hashRound(v2, load64(p + 8));
+            v3 = hashRound(v3, load64(p + 16));
+            v4 = hashRound(v4, load64(p + 24));
+        }
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = hashMerge(h, v1);
+        h = hashMerge(h, v2);
+        h = hashMerge(h, v3);
+        h = hashMerge(h, v4);
+    } else {
+        h = seed + PRIME5;
+    }
+    h += n;
+
+    for (; p + 8 <= end; p += 8) h = rotl64(h ^ hashRound(0, load64(p)), 27) * PRIME1 + PRIME4;
+    for (; p < end; p++) h = rotl64(h ^ (*p * PRIME5), 11) * PRIME1;
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+BlockKey makeBlockKey(const unsigned char* data, size_t n, uint8_t mode) {
+    BlockKey key;
+    key.hash = blockHash64(data, n, mode);
+    key.crc = crc32c(0, data, n);
+    key.size = (uint32_t)n;
+    key.mode = mode;
+    return key;
+}
+
+string BlockKey::name() const {
+    ostringstream out;
+    out << hex << setfill('0') << setw(16) << hash << setw(8) << crc << setw(8) << size << setw(2) << (int)mode;
+    return out.str();
+}
+
+// ===================== CACHE =====================
+
+static uint32_t readU32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int k = 3; k >= 0; k--) v = (v << 8) | p[k];
+    return v;
+}
+
+static uint64_t readU64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int k = 7; k >= 0; k--) v = (v << 8) | p[k];
+    return v;
+}
+
+string BlockCache::defaultDirectory() {
+    if (const char* path = getenv("HUFFMAN_BLOCK_CACHE")) return path;
+    if (const char* path = getenv("XDG_CACHE_HOME")) return string(path) + "/huffman-blocks";
+    if (const char* home = getenv("HOME")) return string(home) + "/.cache/huffman-blocks";
+    if (const char* path = getenv("LOCALAPPDATA")) return string(path) + "\\huffman-blocks";
+    return ".huffman-blocks";
+}
+
+string BlockCache::pathOf(const string& name) const {
+    return (fs::path(dir) / (name + ENTRY_SUFFIX)).string();
+}
+
+bool BlockCache::open(const string& directory, size_t limitBytes) {
+    error_code ec;
+    fs::create_directories(directory, ec);
+    if (!fs::is_directory(directory, ec)) return false;
+
+    lock_guard<mutex> lock(mtx);
+    dir = directory;
+    limit = limitBytes;
+    lru.clear();
+    index.clear();
+    stats = BlockCacheStats();
+
+    // Nạp các mục sẵn có, mục sửa gần nhất (= dùng gần nhất) đứng đầu
+    struct Found {
+        string name;
+        size_t size;
+        fs::file_time_type time;
+    };
+    vector<Found> found;
+    for (const auto& item : fs::directory_iterator(directory, ec)) {
+        string file = item.path().filename().string();
+        size_t suffix = file.size() - strlen(ENTRY_SUFFIX);
+        if (file.size() <= strlen(ENTRY_SUFFIX) || file.compare(suffix, string::npos, ENTRY_SUFFIX) != 0) continue;
+        error_code itemEc;
+        size_t size = (size_t)item.file_size(itemEc);
+        fs::file_time_type time = item.last_write_time(itemEc);
+        if (!itemEc) found.push_back({file.substr(0, suffix), size, time});
+    }
+    sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.time > b.time; });
+    for (const auto& f : found) {
+        lru.push_back({f.name, f.size});
+        index[f.name] = prev(lru.end());
+        stats.bytesUsed += f.size;
+    }
+    // Giới hạn có thể đã nhỏ hơn lần chạy trước
+    evictLocked();
+    return true;
+}
+
+void BlockCache::forget(const string& name) {
+    lock_guard<mutex> lock(mtx);
+    auto it = index.find(name);
+    if (it == index.end()) return;
+    error_code ec;
+    fs::remove(pathOf(name), ec);
+    stats.bytesUsed -= it->second->size;
+    lru.erase(it->second);
+    index.erase(it);
+}
+
+void BlockCache::evictLocked() {
+    while (stats.bytesUsed > limit && !lru.empty()) {
+        const Entry& victim = lru.back();
+        error_code ec;
+        fs::remove(pathOf(victim.name), ec);
+        stats.bytesUsed -= victim.size;
+        stats.evictions++;
+        index.erase(victim.name);
+        lru.pop_back();
+    }
+}
+
+bool BlockCache::lookup(const BlockKey& key, vector<unsigned char>& record) {
+    string name = key.name();
+    record.clear();
+    {
+        lock_guard<mutex> lock(mtx);
+        stats.lookups++;
+        auto it = index.find(name);
+        if (it == index.end()) return false;
+        lru.splice(lru.begin(), lru, it->second); // Đánh dấu dùng gần nhất
+    }
+
+    // Đọc file ngoài khóa. File mất (tiến trình khác đã loại) hoặc hỏng thì bỏ mục đó, coi như không trúng.
+    string path = pathOf(name);
+    ifstream in(path, ios::binary | ios::ate);
+    size_t size = in ? (size_t)in.tellg() : 0;
+    in.seekg(0);
+    record.resize(size);
+    bool valid = in && in.read(reinterpret_cast<char*>(record.data()), size);
+
+    // Bản ghi phải đúng là của block này: loại hợp lệ, độ dài và checksum khớp với khóa. CRC32C trong header
+    // là của dữ liệu gốc nên không bảo vệ payload; hash ở cuối file phát hiện payload bị hỏng trên đĩa.
+    valid = valid && size >= RECORD_HEADER_SIZE + TRAILER_SIZE;
+    if (valid) {
+        size -= TRAILER_SIZE;
+        valid = readU64(record.data() + size) == blockHash64(record.data(), size, 0) && record[0] <= BLOCK_PAIRS
+                && readU32(record.data() + 1) == key.size && readU32(record.data() + 5) == size - RECORD_HEADER_SIZE
+                && readU32(record.data() + 9) == key.crc;
+    }
+    if (!valid) {
+        record.clear();
+        forget(name);
+        return false;
+    }
+
+    record.resize(size);
+
+    // Thời gian sửa file là thứ tự LRU cho lần chạy sau
+    error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    lock_guard<mutex> lock(mtx);
+    stats.hits++;
+    stats.bytesSaved += key.size;
+    return true;
+}
+
+void BlockCache::insert(const BlockKey& key, const unsigned char* record, size_t size) {
+    unsigned char trailer[TRAILER_SIZE];
+    uint64_t check = blockHash64(record, size, 0);
+    for (size_t k = 0; k < TRAILER_SIZE; k++) trailer[k] = (unsigned char)(check >> (8 * k));
+    size_t fileSize = size + TRAILER_SIZE;
+    if (fileSize > limit) return;
+    string name = key.name();
+    {
+        lock_guard<mutex> lock(mtx);
+        if (index.count(name)) return;
+    }
+
+    // Ghi file tạm rồi đổi tên: không luồng / tiến trình nào đọc được mục ghi dở
+    ostringstream tmpName;
+    tmpName << pathOf(name) << ".tmp" << this_thread::get_id();
+    {
+        ofstream out(tmpName.str(), ios::binary);
+        if (!out.write(reinterpret_cast<const char*>(record), size)
+            || !out.write(reinterpret_cast<const char*>(trailer), TRAILER_SIZE)) {
+            out.close();
+            error_code ec;
+            fs::remove(tmpName.str(), ec);
+            return;
+        }
+    }
+    error_code ec;
+    fs::rename(tmpName.str(), pathOf(name), ec);
+    if (ec) {
+        fs::remove(tmpName.str(), ec);
+        return;
+    }
+
+    lock_guard<mutex> lock(mtx);
+    if (index.count(name)) return; // Luồng khác vừa thêm cùng block
+    lru.push_front({name, fileSize});
+    index[name] = lru.begin();
+    stats.bytesUsed += fileSize;
+    stats.inserts++;
+    evictLocked();
+}
+
+BlockCacheStats BlockCache::snapshot() {
+    lock_guard<mutex> lock(mtx);
+    BlockCacheStats s = stats;
+    s.entries = lru.size();
+    s.limitBytes = limit;
+    return s;
+}
+
+string BlockCache::report() {
+    BlockCacheStats s = snapshot();
+    ostringstream out;
+    double rate = s.lookups > 0 ? 100.0 * s.hits / s.lookups : 0;
+    out << "Cache block: " << s.hits << " / " << s.lookups << " block trung (" << fixed << setprecision(1) << rate
+        << "%), bo qua ma hoa " << formatMemorySize(s.bytesSaved) << endl;
+    out << "             " << s.entries << " muc, " << formatMemorySize(s.bytesUsed) << " / "
+        << formatMemorySize(s.limitBytes) << " (LRU), them " << s.inserts << ", loai " << s.evictions << endl;
+    return out.str();
+}
@@ -0,0 +1,83 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANCACHE_H
+#define HUFFMANENCRYPT_HUFFMANCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Khóa của 1 block theo nội dung: hash 64 bit + CRC32C + độ dài + chế độ ký hiệu.
+// Hai hàm băm độc lập (96 bit) nên xác suất 2 block khác nhau trùng khóa không đáng kể;
+// CRC32C cũng là checksum ghi trong bản ghi nên bản ghi lấy từ cache được đối chiếu lại khi dùng.
+struct BlockKey {
+    uint64_t hash;
+    uint32_t crc;
+    uint32_t size;
+    uint8_t mode;
+
+    std::string name() const; // Tên file của mục trong thư mục cache
+};
+
+uint64_t blockHash64(const unsigned char* data, size_t n, uint64_t seed);
+BlockKey makeBlockKey(const unsigned char* data, size_t n, uint8_t mode);
+
+struct BlockCacheStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+    uint64_t bytesSaved = 0; // Tổng byte dữ liệu gốc không phải mã hóa lại
+    size_t entries = 0;
+    size_t bytesUsed = 0;
+    size_t limitBytes = 0;
+};
+
+// Cache trên đĩa: mỗi mục là 1 file chứa bản ghi block đã mã hóa (header block + payload, payload gồm cả
+// bảng mã) và 8 byte hash của bản ghi để kiểm tra khi đọc lại. Giới hạn tổng dung lượng, loại mục dùng lâu nhất (LRU). Thứ tự LRU lưu bằng thời gian sửa file
+// (cập nhật khi trúng cache) nên vẫn đúng qua nhiều lần chạy. Dùng được từ nhiều luồng cùng lúc; nhiều tiến
+// trình dùng chung thư mục vẫn an toàn (ghi file tạm rồi rename) nhưng mỗi tiến trình chỉ đếm dung lượng của mình.
+class BlockCache {
+private:
+    struct Entry {
+        std::string name;
+        size_t size;
+    };
+
+    std::string dir;
+    size_t limit;
+    std::mutex mtx;
+    std::list<Entry> lru; // Đầu danh sách = dùng gần nhất
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    BlockCacheStats stats;
+
+    std::string pathOf(const std::string& name) const;
+    void forget(const std::string& name);
+    void evictLocked();
+
+public:
+    static const size_t DEFAULT_LIMIT = 1ULL << 30;
+
+    BlockCache() : limit(DEFAULT_LIMIT) {}
+
+    // Tạo thư mục nếu chưa có và nạp các mục sẵn có theo thứ tự LRU
+    bool open(const std::string& directory, size_t limitBytes);
+    // Bản ghi đã mã hóa của block có khóa key (đã kiểm tra hash của file, độ dài và CRC32C khớp với khóa).
+    // Không trúng thì record rỗng.
+    bool lookup(const BlockKey& key, std::vector<unsigned char>& record);
+    void insert(const BlockKey& key, const unsigned char* record, size_t size);
+
+    BlockCacheStats snapshot();
+    std::string report();
+    // Thư mục mặc định: $HUFFMAN_BLOCK_CACHE, $XDG_CACHE_HOME/huffman-blocks, ~/.cache/huffman-blocks
+    // hoặc %LOCALAPPDATA%\huffman-blocks
+    static std::string defaultDirectory();
+};
+
+#endif //HUFFMANENCRYPT_HUFFMANCACHE_H
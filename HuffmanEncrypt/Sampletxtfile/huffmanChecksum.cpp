@@ -0,0 +1,154 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanChecksum.h"
+#include "huffmanCpu.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HUFFMAN_HAVE_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+static const uint32_t CRC32C_POLY = 0x82F63B78; // Dạng đảo bit của 0x1EDC6F41
+
+// Bảng slice-by-8: table[k][b] là CRC của byte b theo sau bởi k byte 0
+struct Crc32cTable {
+    uint32_t table[8][256];
+
+    Crc32cTable() {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t c = b;
+            for (int k = 0; k < 8; k++) c = (c >> 1) ^ (CRC32C_POLY & (0u - (c & 1)));
+            table[0][b] = c;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (int k = 1; k < 8; k++) table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+        }
+    }
+};
+
+static const Crc32cTable& crcTable() {
+    static const Crc32cTable t;
+    return t;
+}
+
+static uint64_t loadLE64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int k = 7; k >= 0; k--) v = (v << 8) | p[k];
+    return v;
+}
+
+// Phiên bản phần mềm; nếu freq khác null thì đếm histogram trong cùng vòng lặp
+static uint32_t crc32cSoftware(uint32_t crc, const unsigned char* p, size_t n, uint32_t* freq) {
+    const auto& t = crcTable().table;
+    uint32_t c = ~crc;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v = loadLE64(p + i) ^ c;
+        c = t[7][v & 0xFF] ^ t[6][(v >> 8) & 0xFF] ^ t[5][(v >> 16) & 0xFF] ^ t[4][(v >> 24) & 0xFF] ^
+            t[3][(v >> 32) & 0xFF] ^ t[2][(v >> 40) & 0xFF] ^ t[1][(v >> 48) & 0xFF] ^ t[0][v >> 56];
+        if (freq) {
+            for (int k = 0; k < 8; k++) freq[p[i + k]]++;
+        }
+    }
+    for (; i < n; i++) {
+        c = (c >> 8) ^ t[0][(c ^ p[i]) & 0xFF];
+        if (freq) freq[p[i]]++;
+    }
+    return ~c;
+}
+
+#ifdef HUFFMAN_HAVE_SSE42
+// Chỉ được biên dịch với SSE4.2 qua thuộc tính target; chỉ gọi sau khi cpuHasSse42() xác nhận
+__attribute__((target("sse4.2")))
+static uint32_t crc32cHardware(uint32_t crc, const unsigned char* p, size_t n, uint32_t* freq) {
+    size_t i = 0;
+#if defined(__x86_64__)
+    uint64_t c = ~crc;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        memcpy(&v, p + i, 8);
+        c = _mm_crc32_u64(c, v);
+        if (freq) {
+            for (int k = 0; k < 8; k++) freq[p[i + k]]++;
+        }
+    }
+    uint32_t c32 = (uint32_t)c;
+#else
+    uint32_t c32 = ~crc;
+#endif
+    for (; i < n; i++) {
+        c32 = _mm_crc32_u8(c32, p[i]);
+        if (freq) freq[p[i]]++;
+    }
+    return ~c32;
+}
+#endif
+
+// Theo mức tập lệnh đang chọn (setCpuLevel), không chỉ theo CPU
+bool cpuHasSse42() {
+    return cpuUse(CPU_SSE42);
+}
+
+uint32_t crc32c(uint32_t crc, const unsigned char* data, size_t n) {
+#ifdef HUFFMAN_HAVE_SSE42
+    if (cpuHasSse42()) return crc32cHardware(crc, data, n, nullptr);
+#endif
+    return crc32cSoftware(crc, data, n, nullptr);
+}
+
+void histogramCrc32c(const unsigned char* src, size_t n, uint32_t freq[256], uint32_t& crc) {
+#ifdef HUFFMAN_HAVE_SSE42
+    if (cpuHasSse42()) {
+        crc = crc32cHardware(crc, src, n, freq);
+        return;
+    }
+#endif
+    crc = crc32cSoftware(crc, src, n, freq);
+}
+
+// ===================== Ghép CRC (như crc32_combine của zlib) =====================
+// Nối thêm lengthB byte 0 vào A tương đương nhân trạng thái CRC với ma trận trên GF(2);
+// lũy thừa ma trận theo bình phương liên tiếp nên chi phí O(log lengthB).
+
+static uint32_t gf2MatrixTimes(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    for (; vec; vec >>= 1, mat++) {
+        if (vec & 1) sum ^= *mat;
+    }
+    return sum;
+}
+
+static void gf2MatrixSquare(uint32_t* square, const uint32_t* mat) {
+    for (int n = 0; n < 32; n++) square[n] = gf2MatrixTimes(mat, mat[n]);
+}
+
+uint32_t crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t lengthB) {
+    if (lengthB == 0) return crcA;
+
+    uint32_t even[32], odd[32];
+    // Toán tử cho 1 bit 0
+    odd[0] = CRC32C_POLY;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    gf2MatrixSquare(even, odd); // 2 bit 0
+    gf2MatrixSquare(odd, even); // 4 bit 0
+
+    do {
+        gf2MatrixSquare(even, odd);
+        if (lengthB & 1) crcA = gf2MatrixTimes(even, crcA);
+        lengthB >>= 1;
+        if (lengthB == 0) break;
+
+        gf2MatrixSquare(odd, even);
+        if (lengthB & 1) crcA = gf2MatrixTimes(odd, crcA);
+        lengthB >>= 1;
+    } while (lengthB != 0);
+
+    return crcA ^ crcB;
+}
@@ -0,0 +1,25 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANCHECKSUM_H
+#define HUFFMANENCRYPT_HUFFMANCHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (đa thức Castagnoli). Dùng lệnh crc32 của SSE4.2 khi CPU hỗ trợ (kiểm tra lúc chạy),
+// nếu không thì dùng bảng slice-by-8. Giá trị giống nhau trên mọi kernel.
+// Quy ước giống zlib: bắt đầu với crc = 0, gọi nối tiếp được cho dữ liệu chia nhiều đoạn.
+uint32_t crc32c(uint32_t crc, const unsigned char* data, size_t n);
+
+// CRC32C của (A nối B) từ CRC của A, CRC của B và độ dài B. Cho phép tính checksum từng block
+// song song rồi ghép thành checksum của toàn bộ dữ liệu.
+uint32_t crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t lengthB);
+
+// Đếm histogram và tính CRC32C trong cùng 1 lượt đọc dữ liệu (freq được cộng dồn, không xóa)
+void histogramCrc32c(const unsigned char* src, size_t n, uint32_t freq[256], uint32_t& crc);
+
+bool cpuHasSse42();
+
+#endif //HUFFMANENCRYPT_HUFFMANCHECKSUM_H
@@ -5,12 +5,39 @@
 #ifndef HUFFMANENCRYPT_HUFFMANCOMMON_H
 #define HUFFMANENCRYPT_HUFFMANCOMMON_H
 
+#include <cstdint>
+
+// Mức nén: Exact đếm tần suất trên toàn bộ dữ liệu (mặc định),
+// Fast dựng bảng mã từ một mẫu dữ liệu rồi mã hóa luôn trong 1 lượt
+enum class CompressionLevel { Exact, Fast };
+
+// Thời gian (us) từng bước của lần nén gần nhất bằng engine tuần tự / OpenMP (chế độ đo khả năng mở rộng).
+// Engine tuần tự đọc file và đếm tần suất trong cùng 1 bước: thời gian đó tính vào histogram, read = 0.
+struct StageTimes {
+    long long read = 0;
+    long long histogram = 0;
+    long long build = 0;  // Cây + bảng mã
+    long long encode = 0; // Chế độ mmap: gồm cả ghi file, write = 0
+    long long write = 0;
+
+    long long total() const { return read + histogram + build + encode + write; }
+};
+
+// Header file .huff của engine tuần tự / OpenMP: int mapSize | mapSize x (char, tần suất) | int padding.
+// Bản đầu ghi tần suất int32; tần suất u64 được đánh dấu bằng bit LEGACY_WIDE_FREQ trong mapSize
+// (mapSize thật chỉ từ 1 tới 256) để bộ đọc vẫn đọc được file int32 cũ.
+const int LEGACY_WIDE_FREQ = 0x40000000;
+// Mức Fast: bảng trong header là bảng lấy mẫu (chỉ để dựng lại cây, không phải số lần xuất hiện thật),
+// ngay sau bảng có thêm u64 số ký tự của dữ liệu gốc
+const int LEGACY_SAMPLED_FREQ = 0x20000000;
+
+// Tần suất 64-bit: file > 2 GB có ký tự xuất hiện quá 2^31 lần
 struct Node {
     char ch;
-    int freq;
+    uint64_t freq;
     Node *left, *right;
 
-    Node(char ch, int freq) {
+    Node(char ch, uint64_t freq) {
         left = right = nullptr;
         this->ch = ch;
         this->freq = freq;
@@ -14,7 +14,8 @@ void HuffmanCompressor::encode(Node* root, string str) {
     if (root == nullptr) return;
 
     if (!root->left && !root->right) {
-        huffmanCode[root->ch] = str;
+        // Cây chỉ có 1 lá (file 1 ký tự): dùng mã "0" để dữ liệu vẫn giải mã được
+        huffmanCode[root->ch] = str.empty() ? "0" : str;
     }
 
     encode(root->left, str + "0");
@@ -31,13 +32,13 @@ void HuffmanCompressor::deleteTree(Node* node) {
 // Ghi bảng tần suất vào đầu file để sau này có thể giải nén (Header)
 void HuffmanCompressor::writeHeader(ofstream& outFile) {
     // 1. Ghi số lượng ký tự khác nhau (kích thước map)
-    int mapSize = freqMap.size();
+    int mapSize = (int)freqMap.size() | LEGACY_WIDE_FREQ;
     outFile.write(reinterpret_cast<char*>(&mapSize), sizeof(mapSize));
 
-    // 2. Ghi lần lượt từng cặp (Ký tự, Tần suất)
+    // 2. Ghi lần lượt từng cặp (Ký tự, Tần suất 64-bit)
     for (const auto& pair : freqMap) {
         char ch = pair.first;
-        int freq = pair.second;
+        uint64_t freq = pair.second;
         outFile.write(&ch, sizeof(ch));
         outFile.write(reinterpret_cast<char*>(&freq), sizeof(freq));
     }
@@ -80,6 +81,8 @@ void HuffmanCompressor::compress(const string& inputFilePath, const string& outp
     cout << "Input:  " << inputFilePath << endl;
     cout << "Output: " << outputFilePath << endl << endl;
 
+    times = StageTimes();
+
     // --- BƯỚC 1: ĐỌC FILE VÀ TÍNH TẦN SUẤT ---
     auto start = high_resolution_clock::now();
 
@@ -103,6 +106,7 @@ void HuffmanCompressor::compress(const string& inputFilePath, const string& outp
 
     auto end = high_resolution_clock::now();
     auto duration = duration_cast<microseconds>(end - start);
+    times.histogram = duration.count();
     cout << "[1] Doc file & Tinh tan suat: " << duration.count() << " us" << endl;
     cout << "    So ky tu khac nhau: " << freqMap.size() << endl;
 
@@ -118,7 +122,7 @@ void HuffmanCompressor::compress(const string& inputFilePath, const string& outp
         Node *left = pq.top(); pq.pop();
         Node *right = pq.top(); pq.pop();
 
-        int sum = left->freq + right->freq;
+        uint64_t sum = left->freq + right->freq;
         Node* newNode = new Node('\0', sum);
         newNode->left = left;
         newNode->right = right;
@@ -128,6 +132,7 @@ void HuffmanCompressor::compress(const string& inputFilePath, const string& outp
 
     end = high_resolution_clock::now();
     duration = duration_cast<microseconds>(end - start);
+    times.build = duration.count();
     cout << "[2] Xay dung cay Huffman: " << duration.count() << " us" << endl;
 
     // --- BƯỚC 3: TẠO BẢNG MÃ HUFFMAN ---
@@ -135,16 +140,25 @@ void HuffmanCompressor::compress(const string& inputFilePath, const string& outp
     encode(root, "");
     end = high_resolution_clock::now();
     duration = duration_cast<microseconds>(end - start);
+    times.build += duration.count();
     cout << "[3] Tao bang ma Huffman: " << duration.count() << " us" << endl;
 
+    // Tổng số bit đã biết ngay sau khi có bảng mã: tổng (tần suất x độ dài mã)
+    long long totalBits = 0;
+    for (const auto& pair : freqMap) {
+        totalBits += (long long)pair.second * huffmanCode[pair.first].length();
+    }
+
     // --- BƯỚC 4: MÃ HÓA NỘI DUNG (Trong bo nho) ---
     start = high_resolution_clock::now();
     string encodedStr = "";
+    encodedStr.reserve(totalBits); // Cấp phát đúng 1 lần
     for (char ch : content) {
         encodedStr += huffmanCode[ch];
     }
     end = high_resolution_clock::now();
     duration = duration_cast<microseconds>(end - start);
+    times.encode = duration.count();
     cout << "[4] Ma hoa du lieu (chuoi bit): " << duration.count() << " us" << endl;
 
     // --- BƯỚC 5: GHI FILE NHỊ PHÂN (OUTPUT) ---
@@ -165,16 +179,17 @@ void HuffmanCompressor::compress(const string& inputFilePath, const string& outp
 
     end = high_resolution_clock::now();
     duration = duration_cast<microseconds>(end - start);
+    times.write = duration.count();
     cout << "[5] Ghi file Output (.bin): " << duration.count() << " us" << endl;
 
 
     // --- TỔNG KẾT ---
-    long originalSize = content.length(); // bytes
+    uint64_t originalSize = content.length(); // bytes
 
-    // Lấy kích thước file sau nén
-    ifstream checkFile(outputFilePath, ios::binary | ios::ate);
-    long compressedSize = checkFile.tellg();
-    checkFile.close();
+    // Kích thước file sau nén tính trực tiếp, không cần mở lại file:
+    // header (số ký tự + các cặp ký tự/tần suất) + padding + phần bit đã đóng gói
+    uint64_t compressedSize = sizeof(int) + freqMap.size() * (sizeof(char) + sizeof(uint64_t))
+                              + sizeof(int) + (totalBits + 7) / 8;
 
     cout << "\n--- KET QUA ---" << endl;
     cout << "Kich thuoc goc:     " << originalSize << " bytes" << endl;
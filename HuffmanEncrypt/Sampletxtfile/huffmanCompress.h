@@ -13,9 +13,10 @@
 
 class HuffmanCompressor {
 private:
-    std::map<char, int> freqMap;
+    std::map<char, uint64_t> freqMap;
     std::map<char, std::string> huffmanCode;
     Node* root;
+    StageTimes times;
 
     void encode(Node* root, std::string str);
     void deleteTree(Node* node);
@@ -32,6 +33,7 @@ public:
 
     // Cập nhật: Nhận thêm đường dẫn file đầu ra
     void compress(const std::string& inputFilePath, const std::string& outputFilePath);
+    const StageTimes& stageTimes() const { return times; }
 };
 
 #endif
\ No newline at end of file
@@ -1,63 +1,122 @@
 #include "huffmanCompressPar.h"
+#include "huffmanBlock.h"
+#include "huffmanTuning.h"
+#include "huffmanNuma.h"
 #include <iomanip>
 #include <vector>
 #include <cstring> // cho memset
+#include <algorithm>
+#include <atomic>
 
 using namespace std;
 using namespace std::chrono;
 
-void HuffmanCompressorPar::encode(Node* root, string str) {
+void HuffmanContext::reset() {
+    // Chi phí cố định, không phụ thuộc kích thước lần nén trước: các buffer giữ nguyên dung lượng
+    memset(freqArray, 0, sizeof(freqArray));
+    memset(codeFreq, 0, sizeof(codeFreq));
+    sampled = false;
+    symbolCount = 0;
+    for (auto& code : huffmanCode) code.clear();
+    nodes.clear(); // Node không có destructor nên clear() không duyệt phần tử
+    heap.clear();
+    root = nullptr;
+    times = StageTimes();
+}
+
+size_t HuffmanContext::capacityBytes() const {
+    size_t total = content.capacity() + numaContent.capacity() + nodes.capacity() * sizeof(Node)
+                 + heap.capacity() * sizeof(Node*) + chunkStart.capacity() * sizeof(long long);
+    for (const auto& code : huffmanCode) total += code.capacity();
+    for (const auto& part : partialResults) total += part.capacity();
+    return total;
+}
+
+void HuffmanCompressorPar::encode(HuffmanContext& ctx, Node* root, string str) {
     if (root == nullptr) return;
 
     if (!root->left && !root->right) {
         // Lưu mã vào mảng tra cứu direct access thay vì map
-        huffmanCode[(unsigned char)root->ch] = str;
+        // Cây chỉ có 1 lá: dùng mã "0" thay cho mã rỗng
+        if (str.empty()) ctx.huffmanCode[(unsigned char)root->ch].assign(1, '0');
+        else ctx.huffmanCode[(unsigned char)root->ch] = str;
     }
 
-    encode(root->left, str + "0");
-    encode(root->right, str + "1");
+    encode(ctx, root->left, str + "0");
+    encode(ctx, root->right, str + "1");
 }
 
-void HuffmanCompressorPar::deleteTree(Node* node) {
-    if (node == nullptr) return;
-    deleteTree(node->left);
-    deleteTree(node->right);
-    delete node;
+// Dựng cây trong ctx.nodes: dự trữ trước đủ 511 nút nên con trỏ giữa các nút không bị đổi khi thêm nút
+bool HuffmanCompressorPar::buildTree(HuffmanContext& ctx) {
+    ctx.nodes.reserve(511);
+    for (int i = 0; i < 256; i++) {
+        if (ctx.codeFreq[i] > 0) {
+            ctx.nodes.emplace_back((char)i, ctx.codeFreq[i]);
+            ctx.heap.push_back(&ctx.nodes.back());
+            // Thêm từng nút như priority_queue để thứ tự chọn nút có cùng tần suất (và cây) không đổi
+            push_heap(ctx.heap.begin(), ctx.heap.end(), compare());
+        }
+    }
+    if (ctx.heap.empty()) return false;
+
+    while (ctx.heap.size() != 1) {
+        pop_heap(ctx.heap.begin(), ctx.heap.end(), compare());
+        Node* left = ctx.heap.back(); ctx.heap.pop_back();
+        pop_heap(ctx.heap.begin(), ctx.heap.end(), compare());
+        Node* right = ctx.heap.back(); ctx.heap.pop_back();
+
+        ctx.nodes.emplace_back('\0', left->freq + right->freq);
+        Node* newNode = &ctx.nodes.back();
+        newNode->left = left; newNode->right = right;
+        ctx.heap.push_back(newNode);
+        push_heap(ctx.heap.begin(), ctx.heap.end(), compare());
+    }
+    ctx.root = ctx.heap.front();
+    encode(ctx, ctx.root, ""); // Tạo bảng mã
+    return true;
 }
 
-void HuffmanCompressorPar::writeHeader(ofstream& outFile) {
+void HuffmanCompressorPar::encodeHeader(const HuffmanContext& ctx, string& header) {
     // Đếm số lượng ký tự có tần suất > 0
     int mapSize = 0;
-    for(int i=0; i<256; i++) {
-        if(freqArray[i] > 0) mapSize++;
+    for (int i = 0; i < 256; i++) {
+        if (ctx.codeFreq[i] > 0) mapSize++;
     }
+    mapSize |= LEGACY_WIDE_FREQ; // Tần suất u64 (xem huffmanCommon.h)
+    if (ctx.sampled) mapSize |= LEGACY_SAMPLED_FREQ;
 
-    outFile.write(reinterpret_cast<char*>(&mapSize), sizeof(mapSize));
-
+    header.clear();
+    header.append(reinterpret_cast<const char*>(&mapSize), sizeof(mapSize));
     for (int i = 0; i < 256; i++) {
-        if (freqArray[i] > 0) {
-            char ch = (char)i;
-            int freq = freqArray[i];
-            outFile.write(&ch, sizeof(ch));
-            outFile.write(reinterpret_cast<char*>(&freq), sizeof(freq));
+        if (ctx.codeFreq[i] > 0) {
+            header += (char)i;
+            header.append(reinterpret_cast<const char*>(&ctx.codeFreq[i]), sizeof(uint64_t));
         }
     }
+    if (ctx.sampled) header.append(reinterpret_cast<const char*>(&ctx.symbolCount), sizeof(ctx.symbolCount));
+}
+
+void HuffmanCompressorPar::writeHeader(ofstream& outFile, const HuffmanContext& ctx) const {
+    string header;
+    encodeHeader(ctx, header);
+    outFile.write(header.data(), (streamsize)header.size());
 }
 
-void HuffmanCompressorPar::writeBody(ofstream& outFile, const vector<string>& encodedChunks) {
+void HuffmanCompressorPar::writeBody(ofstream& outFile, const vector<string>& encodedChunks, long long numChunks) const {
     // Phần này vẫn phải làm tuần tự để ghi đúng thứ tự byte vào file
     char buffer = 0;
     int count = 0;
 
     // Tính tổng độ dài bit để tính padding trước
     long long totalBits = 0;
-    for(const auto& s : encodedChunks) totalBits += s.length();
+    for (long long c = 0; c < numChunks; c++) totalBits += encodedChunks[c].length();
 
     int padding = (8 - (totalBits % 8)) % 8;
     outFile.write(reinterpret_cast<char*>(&padding), sizeof(padding));
 
     // Duyệt qua từng chunk (được tạo ra bởi các luồng) và ghi vào file
-    for (const string& chunk : encodedChunks) {
+    for (long long c = 0; c < numChunks; c++) {
+        const string& chunk = encodedChunks[c];
         for (char bit : chunk) {
             buffer = buffer << 1;
             if (bit == '1') buffer = buffer | 1;
@@ -76,12 +135,128 @@ void HuffmanCompressorPar::writeBody(ofstream& outFile, const vector<string>& en
     }
 }
 
+// Ghi không qua buffer trung gian: kích thước file và vị trí bit bắt đầu của từng chunk được tính trước,
+// file output được cấp phát đúng kích thước và ánh xạ vào bộ nhớ, rồi mỗi luồng đóng gói bit của chunk
+// mình thẳng vào vị trí cuối cùng. Chỉ byte đầu / cuối của chunk có thể dùng chung với chunk kề bên
+// nên được ghi bằng phép OR nguyên tử (file mới cấp phát toàn byte 0).
+bool HuffmanCompressorPar::writeMapped(HuffmanContext& ctx, const char* content, long long fileSize, int numThreads,
+                                       long long numChunks, const string& outputFilePath,
+                                       long long& compressedSize) const {
+    long long chunkSize = fileSize / numChunks;
+
+    // Mã dạng số nguyên (MSB trước, giống thứ tự writeBody ghi các bit '0' / '1')
+    struct CodeTable {
+        uint64_t bits[256];
+        int len[256];
+    } table = {};
+    for (int i = 0; i < 256; i++) {
+        table.len[i] = (int)ctx.huffmanCode[i].length();
+        for (char bit : ctx.huffmanCode[i]) table.bits[i] = (table.bits[i] << 1) | (bit == '1');
+    }
+
+    // Vị trí bit bắt đầu của mỗi chunk = tổng độ dài mã của các chunk trước nó
+    vector<long long>& chunkStart = ctx.chunkStart;
+    chunkStart.assign(numChunks + 1, 0);
+    #pragma omp parallel num_threads(numThreads) if(numThreads > 1)
+    {
+        // NUMA: luồng đã ghim dùng bản sao bảng mã trên stack của chính nó (bộ nhớ cùng node)
+        CodeTable local;
+        const int* codeLen = table.len;
+        if (numaAware) {
+            pinCurrentThread(omp_get_thread_num(), omp_get_num_threads());
+            local = table;
+            codeLen = local.len;
+        }
+
+        #pragma omp for schedule(static)
+        for (long long chunk = 0; chunk < numChunks; chunk++) {
+            long long startIdx = chunk * chunkSize;
+            long long endIdx = (chunk == numChunks - 1) ? fileSize : startIdx + chunkSize;
+            long long bits = 0;
+            for (long long i = startIdx; i < endIdx; i++) bits += codeLen[(unsigned char)content[i]];
+            chunkStart[chunk + 1] = bits;
+        }
+    }
+    for (long long chunk = 0; chunk < numChunks; chunk++) chunkStart[chunk + 1] += chunkStart[chunk];
+    // Kích thước file lấy từ số bit thực của các chunk (ở mức Fast không tính trước được từ tần suất)
+    long long totalBits = chunkStart[numChunks];
+
+    // Header giống writeHeader, rồi padding
+    string header;
+    encodeHeader(ctx, header);
+    compressedSize = (long long)(header.size() + sizeof(int)) + (totalBits + 7) / 8;
+
+    MappedOutputFile out;
+    if (!out.create(outputFilePath, (size_t)compressedSize)) return false;
+    unsigned char* p = out.data();
+    memcpy(p, header.data(), header.size());
+    p += header.size();
+    int padding = (8 - (totalBits % 8)) % 8;
+    memcpy(p, &padding, sizeof(padding));
+    unsigned char* body = p + sizeof(padding);
+
+    #pragma omp parallel num_threads(numThreads) if(numThreads > 1)
+    {
+        CodeTable local;
+        const CodeTable* codes = &table;
+        if (numaAware) {
+            pinCurrentThread(omp_get_thread_num(), omp_get_num_threads());
+            local = table;
+            codes = &local;
+        }
+
+        // Lịch chia chunk do compress() chọn: dynamic, hoặc static (khối liền nhau) ở chế độ NUMA
+        #pragma omp for schedule(runtime)
+        for (long long chunk = 0; chunk < numChunks; chunk++) {
+            long long startIdx = chunk * chunkSize;
+            long long endIdx = (chunk == numChunks - 1) ? fileSize : startIdx + chunkSize;
+
+            unsigned char* dst = body + chunkStart[chunk] / 8;
+            int pending = (int)(chunkStart[chunk] % 8); // Các bit đầu của byte đầu tiên thuộc chunk trước
+            bool shared = pending > 0;
+            uint64_t acc = 0;
+
+            for (long long i = startIdx; i < endIdx; i++) {
+                unsigned char ch = (unsigned char)content[i];
+                acc = (acc << codes->len[ch]) | codes->bits[ch];
+                pending += codes->len[ch];
+                while (pending >= 8) {
+                    pending -= 8;
+                    unsigned char byte = (unsigned char)(acc >> pending);
+                    if (shared) {
+                        atomic_ref<unsigned char>(*dst).fetch_or(byte, memory_order_relaxed);
+                        shared = false;
+                    } else {
+                        *dst = byte;
+                    }
+                    dst++;
+                }
+                acc &= (1ULL << pending) - 1;
+            }
+
+            // Byte cuối dở dang dùng chung với chunk sau (hoặc là byte đệm cuối file)
+            if (pending > 0) {
+                unsigned char byte = (unsigned char)(acc << (8 - pending));
+                atomic_ref<unsigned char>(*dst).fetch_or(byte, memory_order_relaxed);
+            }
+        }
+    }
+
+    return out.close();
+}
+
 void HuffmanCompressorPar::compress(const string& inputFilePath, const string& outputFilePath) {
+    compress(inputFilePath, outputFilePath, context);
+}
+
+void HuffmanCompressorPar::compress(const string& inputFilePath, const string& outputFilePath, HuffmanContext& ctx) const {
+    ctx.reset();
+    uint64_t* freqArray = ctx.freqArray;
+    const string* huffmanCode = ctx.huffmanCode;
+    string& content = ctx.content;
+
     cout << "--- BAT DAU QUA TRINH NEN HUFFMAN (SONG SONG - OPENMP) ---" << endl;
 
-    // Thiết lập số lượng luồng (Threads)
-    int numThreads = omp_get_max_threads();
-    cout << "So luong luong (Threads) su dung: " << numThreads << endl;
     cout << "Input:  " << inputFilePath << endl;
     cout << "Output: " << outputFilePath << endl << endl;
 
@@ -92,112 +267,195 @@ void HuffmanCompressorPar::compress(const string& inputFilePath, const string& o
 
     // Di chuyển con trỏ đến cuối để lấy kích thước
     inFile.seekg(0, ios::end);
-    long fileSize = inFile.tellg();
+    long long fileSize = (long long)inFile.tellg();
     inFile.seekg(0, ios::beg);
 
-    // Đọc toàn bộ file vào buffer bộ nhớ
-    string content;
-    content.resize(fileSize);
-    inFile.read(&content[0], fileSize);
-    inFile.close();
+    // Thiết lập số lượng luồng (Threads) và số chunk theo kích thước file.
+    // Dưới ngưỡng hòa vốn, chạy tuần tự (if(numThreads > 1) bỏ qua fork/join của OpenMP).
+    ParallelPlan plan;
+    if (threadOverride > 0) plan = {threadOverride, (size_t)threadOverride};
+    else plan = ParallelTuner::instance(TUNE_ENGINE_STRING).plan(fileSize);
+    int numThreads = plan.threads;
+    start = high_resolution_clock::now(); // Không tính lần hiệu chỉnh mô hình đầu tiên vào bước đọc file
+
+    // Luồng bị ghim trong lúc nén được trả về affinity ban đầu khi ra khỏi hàm (kể cả khi lỗi)
+    struct UnpinGuard {
+        bool active;
+        int threads;
+        ~UnpinGuard() {
+            if (!active) return;
+            #pragma omp parallel num_threads(threads) if(threads > 1)
+            unpinCurrentThread();
+        }
+    } unpinGuard = {numaAware, numThreads};
+
+    const char* src;
+    if (numaAware) {
+        // Mỗi luồng (đã ghim) đọc đoạn input của mình: trang nhớ nằm trên node sẽ đếm và mã hóa đoạn đó
+        inFile.close();
+        if (!readFileFirstTouch(inputFilePath, ctx.numaContent, numThreads)) { cerr << "Loi mo file input" << endl; return; }
+        fileSize = (long long)ctx.numaContent.size();
+        src = ctx.numaContent.data();
+    } else {
+        // Đọc toàn bộ file vào buffer bộ nhớ
+        content.resize(fileSize);
+        inFile.read(&content[0], fileSize);
+        inFile.close();
+        src = content.data();
+    }
 
-    if (content.empty()) return;
+    if (fileSize == 0) return;
     auto end = high_resolution_clock::now();
-    cout << "[1] Doc file vao RAM: " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    ctx.times.read = duration_cast<microseconds>(end - start).count();
+    cout << "[1] Doc file vao RAM" << (numaAware ? " (NUMA first-touch)" : "") << ": " << ctx.times.read << " us" << endl;
+
+    long long numChunks = (long long)min<size_t>(plan.chunks, (size_t)fileSize);
+    cout << "    So luong luong (Threads) su dung: " << numThreads << ", so chunk: " << numChunks;
+    if (numThreads == 1) cout << " (tuan tu - file nho hon nguong hoa von)";
+    cout << endl;
 
 
     // --- BƯỚC 2: TÍNH TẦN SUẤT (SONG SONG) ---
     // KỸ THUẬT: Data Parallelism (Phân chia dữ liệu) + Reduction (Gộp kết quả)
     start = high_resolution_clock::now();
 
-    #pragma omp parallel
-    {
-        long localFreq[256] = {0}; // Mảng cục bộ cho mỗi luồng (Private)
+    ctx.symbolCount = (uint64_t)fileSize;
+    if (level == CompressionLevel::Fast) {
+        // Mức Fast: đếm trên các cửa sổ mẫu trải đều file. Mọi ký tự đều có tần suất >= 1
+        // nên ký tự không gặp trong mẫu vẫn có mã, và file chỉ cần đọc 1 lượt để mã hóa.
+        // Bảng mẫu chỉ dùng để dựng cây; freqArray (số lần xuất hiện thật) không được đếm.
+        sampleFrequency(reinterpret_cast<const unsigned char*>(src), fileSize, ctx.codeFreq);
+        ctx.sampled = true;
+    } else {
+        #pragma omp parallel num_threads(numThreads) if(numThreads > 1)
+        {
+            uint64_t localFreq[256] = {0}; // Mảng cục bộ cho mỗi luồng (Private)
+            if (numaAware) pinCurrentThread(omp_get_thread_num(), omp_get_num_threads());
 
-        // Phân chia vòng lặp cho các luồng
-        #pragma omp for schedule(static)
-        for (long i = 0; i < fileSize; i++) {
-            localFreq[(unsigned char)content[i]]++;
-        }
+            // Phân chia vòng lặp cho các luồng (static: đoạn liền nhau, trùng với đoạn đã đọc ở chế độ NUMA)
+            #pragma omp for schedule(static)
+            for (long long i = 0; i < fileSize; i++) {
+                localFreq[(unsigned char)src[i]]++;
+            }
 
-        // Gộp kết quả cục bộ vào mảng toàn cục (Critical Section)
-        #pragma omp critical
-        {
-            for (int i = 0; i < 256; i++) {
-                freqArray[i] += localFreq[i];
+            // Gộp kết quả cục bộ vào mảng toàn cục (Critical Section)
+            #pragma omp critical
+            {
+                for (int i = 0; i < 256; i++) {
+                    freqArray[i] += localFreq[i];
+                }
             }
         }
+        memcpy(ctx.codeFreq, freqArray, sizeof(ctx.codeFreq));
     }
 
     end = high_resolution_clock::now();
-    cout << "[2] Tinh tan suat (Song song): " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    ctx.times.histogram = duration_cast<microseconds>(end - start).count();
+    cout << "[2] Tinh tan suat (" << (level == CompressionLevel::Fast ? "Lay mau" : "Song song") << "): " << ctx.times.histogram << " us" << endl;
 
 
     // --- BƯỚC 3: XÂY DỰNG CÂY VÀ BẢNG MÃ (TUẦN TỰ) ---
     // Bước này rất nhanh và khó song song hóa hiệu quả do phụ thuộc dữ liệu
     start = high_resolution_clock::now();
-    priority_queue<Node*, vector<Node*>, compare> pq;
+    if (!buildTree(ctx)) return;
+    end = high_resolution_clock::now();
+    ctx.times.build = duration_cast<microseconds>(end - start).count();
+    cout << "[3] Xay dung cay & bang ma (Tuan tu): " << ctx.times.build << " us" << endl;
+
+    // Mức Exact: kích thước nén chính xác đã biết trước khi mã hóa: tổng (tần suất x độ dài mã).
+    // Mức Fast chỉ biết sau khi mã hóa (tần suất thật không được đếm); totalBits dưới đây chỉ là ước lượng
+    // để dự trữ buffer.
+    long long totalBits = 0;
+    const uint64_t* bitWeights = ctx.sampled ? ctx.codeFreq : freqArray;
+    uint64_t weightSum = 0;
     for (int i = 0; i < 256; i++) {
-        if (freqArray[i] > 0)
-            pq.push(new Node((char)i, freqArray[i]));
+        totalBits += bitWeights[i] * (long long)huffmanCode[i].length();
+        weightSum += bitWeights[i];
     }
-
-    if (pq.empty()) return;
-
-    while (pq.size() != 1) {
-        Node *left = pq.top(); pq.pop();
-        Node *right = pq.top(); pq.pop();
-        Node* newNode = new Node('\0', left->freq + right->freq);
-        newNode->left = left; newNode->right = right;
-        pq.push(newNode);
+    if (ctx.sampled) totalBits = (long long)((double)totalBits / weightSum * fileSize);
+    string header;
+    encodeHeader(ctx, header);
+    long long compressedSize = (long long)(header.size() + sizeof(int)) + (totalBits + 7) / 8;
+    if (!ctx.sampled) cout << "    Kich thuoc nen (tinh truoc): " << compressedSize << " bytes" << endl;
+
+    // Chế độ NUMA chia chunk theo khối liền nhau (static) để luồng mã hóa đúng đoạn input nó đã đọc,
+    // và luồng giữ cùng các chunk qua nhiều lần nén (buffer output được chạm lần đầu bởi chính luồng đó)
+    omp_set_schedule(numaAware ? omp_sched_static : omp_sched_dynamic, 0);
+
+    if (outputMode == OutputMode::Mmap) {
+        // --- BƯỚC 4+5: MÃ HÓA THẲNG VÀO FILE ÁNH XẠ (SONG SONG) ---
+        start = high_resolution_clock::now();
+        if (!writeMapped(ctx, src, fileSize, numThreads, numChunks, outputFilePath, compressedSize)) {
+            cerr << "Loi: Khong the ghi file output (mmap)!" << endl;
+            return;
+        }
+        end = high_resolution_clock::now();
+        ctx.times.encode = duration_cast<microseconds>(end - start).count();
+        cout << "[4] Ma hoa thang vao file anh xa (mmap, song song): " << ctx.times.encode << " us" << endl;
+        if (ctx.sampled) cout << "    Kich thuoc nen: " << compressedSize << " bytes" << endl;
+        cout << "----------------------------------------------" << endl;
+        return;
     }
-    root = pq.top();
-    encode(root, ""); // Tạo bảng mã
-    end = high_resolution_clock::now();
-    cout << "[3] Xay dung cay & bang ma (Tuan tu): " << duration_cast<microseconds>(end - start).count() << " us" << endl;
 
 
     // --- BƯỚC 4: MÃ HÓA DỮ LIỆU (SONG SONG) ---
     // KỸ THUẬT: Data Decomposition (Chia nhỏ chuỗi đầu vào)
     start = high_resolution_clock::now();
 
-    // Mỗi luồng sẽ lưu kết quả mã hóa của phần dữ liệu mình phụ trách vào đây
-    vector<string> partialResults(numThreads);
+    // Mỗi chunk lưu kết quả mã hóa của phần dữ liệu tương ứng vào đây
+    vector<string>& partialResults = ctx.partialResults;
+    if ((long long)partialResults.size() < numChunks) partialResults.resize(numChunks);
 
-    #pragma omp parallel
+    #pragma omp parallel num_threads(numThreads) if(numThreads > 1)
     {
-        int tid = omp_get_thread_num(); // Lấy ID của luồng hiện tại
-        int n_threads = omp_get_num_threads();
-
-        // Chia file thành các đoạn (chunk) cho mỗi luồng
-        long chunkSize = fileSize / n_threads;
-        long startIdx = tid * chunkSize;
-        long endIdx = (tid == n_threads - 1) ? fileSize : startIdx + chunkSize;
-
-        string localEncoded = "";
-        // Dự trữ bộ nhớ để tránh cấp phát liên tục (Heuristic: 1 char ~ 8 bits nhưng trung bình Huffman < 8)
-        localEncoded.reserve((endIdx - startIdx) * 5);
-
-        for (long i = startIdx; i < endIdx; i++) {
-            // Tra cứu trong mảng huffmanCode (nhanh hơn map)
-            localEncoded += huffmanCode[(unsigned char)content[i]];
+        // NUMA: luồng đã ghim dùng bản sao bảng mã của riêng nó thay vì đọc bảng trên node của luồng chính
+        string localCode[256];
+        const string* codeTable = huffmanCode;
+        if (numaAware) {
+            pinCurrentThread(omp_get_thread_num(), omp_get_num_threads());
+            for (int i = 0; i < 256; i++) localCode[i] = huffmanCode[i];
+            codeTable = localCode;
         }
 
-        partialResults[tid] = localEncoded;
+        #pragma omp for schedule(runtime)
+        for (long long chunk = 0; chunk < numChunks; chunk++) {
+            // Chia file thành các đoạn (chunk), số chunk có thể lớn hơn số luồng để cân bằng tải
+            long long chunkSize = fileSize / numChunks;
+            long long startIdx = chunk * chunkSize;
+            long long endIdx = (chunk == numChunks - 1) ? fileSize : startIdx + chunkSize;
+
+            // Dùng lại buffer của lần nén trước (clear() giữ dung lượng)
+            string& localEncoded = partialResults[chunk];
+            localEncoded.clear();
+            // Dự trữ bộ nhớ theo độ dài mã trung bình (totalBits / fileSize) để tránh cấp phát lại
+            localEncoded.reserve((size_t)((double)totalBits / fileSize * (endIdx - startIdx)) + 64);
+
+            for (long long i = startIdx; i < endIdx; i++) {
+                // Tra cứu trong mảng huffmanCode (nhanh hơn map)
+                localEncoded += codeTable[(unsigned char)src[i]];
+            }
+        }
     }
 
     end = high_resolution_clock::now();
-    cout << "[4] Ma hoa du lieu (Song song): " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    ctx.times.encode = duration_cast<microseconds>(end - start).count();
+    cout << "[4] Ma hoa du lieu (Song song): " << ctx.times.encode << " us" << endl;
 
 
     // --- BƯỚC 5: GHI FILE (TUẦN TỰ) ---
     start = high_resolution_clock::now();
     ofstream outFile(outputFilePath, ios::binary);
-    writeHeader(outFile);
-    writeBody(outFile, partialResults); // Hàm này sẽ ghép các mảnh lại
+    writeHeader(outFile, ctx);
+    writeBody(outFile, partialResults, numChunks); // Hàm này sẽ ghép các mảnh lại
     outFile.close();
     end = high_resolution_clock::now();
-    cout << "[5] Ghi file Output: " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    ctx.times.write = duration_cast<microseconds>(end - start).count();
+    cout << "[5] Ghi file Output: " << ctx.times.write << " us" << endl;
+    if (ctx.sampled) {
+        long long encodedBits = 0;
+        for (long long c = 0; c < numChunks; c++) encodedBits += (long long)partialResults[c].length();
+        cout << "    Kich thuoc nen: " << (long long)(header.size() + sizeof(int)) + (encodedBits + 7) / 8 << " bytes" << endl;
+    }
 
     cout << "----------------------------------------------" << endl;
 }
\ No newline at end of file
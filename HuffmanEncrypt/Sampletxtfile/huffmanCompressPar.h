@@ -18,26 +18,75 @@
 #include <chrono>
 #include <omp.h> // Thư viện OpenMP
 #include "huffmanCommon.h"
+#include "huffmanIo.h"
+#include "huffmanNuma.h"
 
 
-class HuffmanCompressorPar {
-private:
+// Trạng thái của 1 lần nén: tần suất, cây, bảng mã và các buffer trung gian. Mỗi luồng giữ 1 context
+// riêng và dùng lại nó qua nhiều lần nén; reset() chỉ xóa tần suất và đánh dấu cây rỗng, các buffer
+// giữ nguyên dung lượng đã cấp phát nên lần nén sau không phải cấp phát lại.
+class HuffmanContext {
+public:
     // Dùng mảng 256 phần tử thay vì Map để tối ưu tốc độ truy cập mảng song song
-    long freqArray[256] = {0};
+    uint64_t freqArray[256]; // 64-bit ở mọi nền tảng (long chỉ 32-bit trên Windows)
+    uint64_t codeFreq[256];  // Trọng số dựng cây: bằng freqArray, hoặc bảng lấy mẫu ở mức Fast
+    bool sampled;            // Mức Fast: freqArray chưa được đếm, header mang codeFreq + symbolCount
+    uint64_t symbolCount;    // Số ký tự của input
     std::string huffmanCode[256]; // Bảng mã dạng mảng để tra cứu nhanh (O(1))
+    std::vector<Node> nodes;      // Các nút của cây nằm liền nhau (tối đa 511), không new / delete từng nút
+    std::vector<Node*> heap;      // Hàng đợi ưu tiên khi dựng cây
     Node* root;
 
-    void encode(Node* root, std::string str);
-    void deleteTree(Node* node);
+    std::string content;                     // Dữ liệu input
+    NumaBuffer numaContent;                  // Dữ liệu input ở chế độ NUMA (mỗi luồng chạm lần đầu đoạn của mình)
+    std::vector<std::string> partialResults; // Kết quả mã hóa của từng chunk
+    std::vector<long long> chunkStart;       // Vị trí bit bắt đầu của từng chunk (chế độ mmap)
+    StageTimes times;                        // Thời gian từng bước của lần nén gần nhất
 
-    void writeHeader(std::ofstream& outFile);
-    void writeBody(std::ofstream& outFile, const std::vector<std::string>& encodedChunks);
+    HuffmanContext() { reset(); }
+
+    void reset();
+    // Tổng dung lượng buffer đang giữ (để theo dõi khi dùng lại context)
+    size_t capacityBytes() const;
+};
+
+// Bộ nén song song. Các thiết lập (mức nén, số luồng, chế độ ghi) không đổi trong lúc nén và mô hình
+// ParallelTuner dùng chung là bất biến, nên nhiều luồng có thể gọi compress(..., ctx) trên cùng 1 bộ nén
+// miễn là mỗi luồng dùng context của riêng mình.
+class HuffmanCompressorPar {
+private:
+    CompressionLevel level;
+    int threadOverride; // 0 = tự chọn theo mô hình chi phí (ParallelTuner)
+    OutputMode outputMode;
+    bool numaAware;
+    HuffmanContext context; // Context mặc định cho compress(input, output)
+
+    static void encode(HuffmanContext& ctx, Node* root, std::string str);
+    static bool buildTree(HuffmanContext& ctx);
+
+    // Header (không gồm padding): mapSize, các cặp (ký tự, tần suất), và số ký tự nếu bảng là bảng mẫu
+    static void encodeHeader(const HuffmanContext& ctx, std::string& header);
+    void writeHeader(std::ofstream& outFile, const HuffmanContext& ctx) const;
+    void writeBody(std::ofstream& outFile, const std::vector<std::string>& encodedChunks, long long numChunks) const;
+    bool writeMapped(HuffmanContext& ctx, const char* content, long long fileSize, int numThreads,
+                     long long numChunks, const std::string& outputFilePath, long long& compressedSize) const;
 
 public:
-    HuffmanCompressorPar() : root(nullptr) {}
-    ~HuffmanCompressorPar() { deleteTree(root); }
+    HuffmanCompressorPar()
+        : level(CompressionLevel::Exact), threadOverride(0), outputMode(OutputMode::Stream), numaAware(false) {}
+
+    // Fast: dựng bảng mã từ mẫu dữ liệu, bỏ qua lượt đếm tần suất trên toàn file
+    void setLevel(CompressionLevel l) { level = l; }
+    // Ép số luồng (0 = tự chọn theo kích thước input)
+    void setThreads(int threads) { threadOverride = threads; }
+    // Mmap: mỗi luồng ghi bit của chunk mình thẳng vào file output đã cấp phát trước
+    void setOutputMode(OutputMode mode) { outputMode = mode; }
+    // Ghim luồng theo node NUMA, mỗi luồng đọc (first-touch) đoạn input và giữ các chunk output của mình
+    void setNumaAware(bool enabled) { numaAware = enabled; }
 
     void compress(const std::string& inputFilePath, const std::string& outputFilePath);
+    // Nén với context do người gọi giữ (context được reset ở đầu mỗi lần nén)
+    void compress(const std::string& inputFilePath, const std::string& outputFilePath, HuffmanContext& ctx) const;
 };
 
 #endif
@@ -0,0 +1,76 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanCpu.h"
+#include <atomic>
+
+using namespace std;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HUFFMAN_HAVE_CPUID 1
+#endif
+
+// Mức đang chọn. Đọc ở mỗi lần gọi kernel (1 lần / block) nên chỉ là 1 phép load
+static atomic<int> selectedLevel((int)CpuLevel::Auto);
+
+bool cpuDetected(CpuFeature feature) {
+#ifdef HUFFMAN_HAVE_CPUID
+    static const bool sse42 = __builtin_cpu_supports("sse4.2");
+    static const bool bmi2 = __builtin_cpu_supports("bmi2");
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    switch (feature) {
+        case CPU_SSE42: return sse42;
+        case CPU_BMI2: return bmi2;
+        case CPU_AVX2: return avx2;
+    }
+#else
+    (void)feature;
+#endif
+    return false;
+}
+
+bool cpuUse(CpuFeature feature) {
+    if (!cpuDetected(feature)) return false;
+    switch ((CpuLevel)selectedLevel.load(memory_order_relaxed)) {
+        case CpuLevel::Generic: return false;
+        case CpuLevel::Sse42: return feature == CPU_SSE42;
+        default: return true;
+    }
+}
+
+void setCpuLevel(CpuLevel level) { selectedLevel = (int)level; }
+
+CpuLevel cpuLevel() { return (CpuLevel)selectedLevel.load(); }
+
+bool parseCpuLevel(const string& text, CpuLevel& level) {
+    if (text == "auto") level = CpuLevel::Auto;
+    else if (text == "generic") level = CpuLevel::Generic;
+    else if (text == "sse4.2") level = CpuLevel::Sse42;
+    else if (text == "avx2") level = CpuLevel::Avx2;
+    else return false;
+    return true;
+}
+
+const char* cpuLevelName(CpuLevel level) {
+    switch (level) {
+        case CpuLevel::Generic: return "generic";
+        case CpuLevel::Sse42: return "sse4.2";
+        case CpuLevel::Avx2: return "avx2";
+        default: return "auto";
+    }
+}
+
+string cpuKernelReport() {
+    string report = "CPU: ";
+    report += cpuDetected(CPU_SSE42) ? "sse4.2 " : "";
+    report += cpuDetected(CPU_BMI2) ? "bmi2 " : "";
+    report += cpuDetected(CPU_AVX2) ? "avx2 " : "";
+    if (!cpuDetected(CPU_SSE42) && !cpuDetected(CPU_BMI2) && !cpuDetected(CPU_AVX2)) report += "(khong co tap lenh mo rong) ";
+    report += string("| muc toi da: ") + cpuLevelName(cpuLevel()) + "\n";
+    report += string("  histogram + crc32c: ") + (cpuUse(CPU_SSE42) ? "sse4.2" : "generic") + "\n";
+    report += string("  dong goi bit:       ") + (cpuUse(CPU_BMI2) ? "bmi2" : "generic") + "\n";
+    report += string("  giai ma bang tra:   ")
+            + (cpuUse(CPU_AVX2) ? "avx2" : cpuUse(CPU_BMI2) ? "bmi2" : "generic") + "\n";
+    return report;
+}
@@ -0,0 +1,41 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANCPU_H
+#define HUFFMANENCRYPT_HUFFMANCPU_H
+
+#include <string>
+
+// Chọn biến thể kernel theo CPU lúc chạy. Project được biên dịch với cờ mặc định (chạy được trên mọi
+// máy x86-64); các kernel dùng BMI2 / SSE4.2 / AVX2 được biên dịch riêng qua thuộc tính target và chỉ
+// được gọi khi cpuid xác nhận CPU có tập lệnh đó.
+//
+//   histogram + CRC32C : sse4.2 (lệnh crc32)  | generic (bảng slice-by-8)
+//   đóng gói bit       : bmi2 (shlx / shrx)   | generic
+//   giải mã bảng tra   : avx2 (8 lane gather) | bmi2 | generic
+
+enum CpuFeature {
+    CPU_SSE42,
+    CPU_BMI2,
+    CPU_AVX2,
+};
+
+// Mức tập lệnh tối đa được phép dùng (để so sánh các biến thể khi đo hiệu năng).
+// Auto = dùng mọi tính năng CPU có; Avx2 tương ứng x86-64-v3 (gồm cả BMI2).
+enum class CpuLevel { Auto, Generic, Sse42, Avx2 };
+
+// CPU thực có tính năng này (cpuid, kiểm tra 1 lần)
+bool cpuDetected(CpuFeature feature);
+// Kernel được phép dùng tính năng này: CPU có và nằm trong mức đã chọn
+bool cpuUse(CpuFeature feature);
+
+void setCpuLevel(CpuLevel level);
+CpuLevel cpuLevel();
+bool parseCpuLevel(const std::string& text, CpuLevel& level);
+const char* cpuLevelName(CpuLevel level);
+
+// Tính năng CPU phát hiện được và biến thể đang chọn cho từng kernel (nhiều dòng)
+std::string cpuKernelReport();
+
+#endif //HUFFMANENCRYPT_HUFFMANCPU_H
@@ -0,0 +1,614 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanDaemon.h"
+#include "huffmanBlockCompressor.h"
+#include "huffmanPipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+static void putU32(unsigned char* p, uint32_t v) {
+    for (int k = 0; k < 4; k++) p[k] = (unsigned char)(v >> (8 * k));
+}
+
+static void putU64(unsigned char* p, uint64_t v) {
+    for (int k = 0; k < 8; k++) p[k] = (unsigned char)(v >> (8 * k));
+}
+
+static uint32_t getU32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int k = 3; k >= 0; k--) v = (v << 8) | p[k];
+    return v;
+}
+
+static uint64_t getU64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int k = 7; k >= 0; k--) v = (v << 8) | p[k];
+    return v;
+}
+
+static double nowSeconds() {
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count() / 1e6;
+}
+
+// ===================== Thống kê =====================
+
+void DaemonStats::record(DaemonOp op, bool ok, uint64_t in, uint64_t out, uint64_t us) {
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && (1ULL << bucket) <= us) bucket++;
+
+    lock_guard<mutex> lock(mtx);
+    if (op < 5) requests[op]++;
+    if (!ok) failures++;
+    bytesIn += in;
+    bytesOut += out;
+    busyUs += us;
+    latency[bucket]++;
+}
+
+// Cận trên của bucket chứa phân vị p
+uint64_t DaemonStats::percentileUs(double p) const {
+    uint64_t total = 0;
+    for (uint64_t c : latency) total += c;
+    if (total == 0) return 0;
+    uint64_t target = (uint64_t)(p * total);
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += latency[b];
+        if (seen > target) return 1ULL << b;
+    }
+    return 1ULL << (LATENCY_BUCKETS - 1);
+}
+
+string DaemonStats::report(double uptimeSeconds, int workers) {
+    uint64_t hits = 0, misses = 0;
+    decodeTableCacheStats(hits, misses);
+
+    lock_guard<mutex> lock(mtx);
+    uint64_t handled = requests[DAEMON_COMPRESS] + requests[DAEMON_DECOMPRESS];
+    ostringstream out;
+    out << fixed << setprecision(1);
+    out << "Thoi gian chay:      " << uptimeSeconds << " s, " << workers << " worker\n";
+    out << "Yeu cau nen / giai nen / stats: " << requests[DAEMON_COMPRESS] << " / " << requests[DAEMON_DECOMPRESS]
+        << " / " << requests[DAEMON_STATS] << " (loi: " << failures << ")\n";
+    out << "Du lieu vao / ra:    " << bytesIn << " / " << bytesOut << " bytes\n";
+    if (busyUs > 0) out << "Thong luong (khi ban): " << bytesIn / (double)busyUs << " MB/s\n";
+    if (handled > 0) {
+        out << "Do tre trung binh:   " << busyUs / (double)handled << " us\n";
+        out << "Do tre p50 / p99:    <= " << percentileUs(0.50) << " / <= " << percentileUs(0.99) << " us\n";
+    }
+    out << "Cache bang giai ma:  " << hits << " trung / " << misses << " truot\n";
+    return out.str();
+}
+
+#ifndef _WIN32
+
+// ===================== I/O socket =====================
+
+static const int POLL_INTERVAL_MS = 200;
+
+static bool readFull(int fd, void* buf, size_t len) {
+    char* p = (char*)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Đọc phía daemon: chờ bằng poll có timeout để kiểm tra cờ dừng; client không gửi thêm byte nào trong
+// DAEMON_STALL_MS thì bỏ kết nối (client treo / chậm không giữ worker mãi)
+static bool readFullServer(int fd, void* buf, size_t len, const atomic<bool>& stopping) {
+    char* p = (char*)buf;
+    int waited = 0;
+    while (len > 0) {
+        if (stopping) return false;
+        pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, POLL_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR) return false;
+        if (ready <= 0) {
+            if (ready == 0 && (waited += POLL_INTERVAL_MS) >= DAEMON_STALL_MS) return false;
+            continue;
+        }
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        waited = 0;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool writeFull(int fd, const void* buf, size_t len) {
+    const char* p = (const char*)buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool sendResponse(int fd, uint32_t status, const void* payload, uint64_t size, bool inlinePayload) {
+    unsigned char header[HUFD_RESPONSE_SIZE] = {0};
+    putU32(header, status);
+    putU64(header + 8, size);
+    if (!writeFull(fd, header, HUFD_RESPONSE_SIZE)) return false;
+    return !inlinePayload || size == 0 || writeFull(fd, payload, size);
+}
+
+// Ánh xạ vùng nhớ chia sẻ do client tạo
+struct SharedRegion {
+    unsigned char* base = nullptr;
+    size_t size = 0;
+
+    bool open(const string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0 && st.st_size > 0;
+        if (ok) {
+            size = (size_t)st.st_size;
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ok = p != MAP_FAILED;
+            if (ok) base = (unsigned char*)p;
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    ~SharedRegion() {
+        if (base) munmap(base, size);
+    }
+};
+
+// Kết nối tới daemon. Luồng accept nhận dần header + tên shm bằng recv không chặn; chỉ khi đủ thì kết nối
+// mới được giao cho worker, nên client gửi dở header không giữ worker nào.
+struct DaemonConnection {
+    int fd;
+    unsigned char head[HUFD_REQUEST_SIZE + 255];
+    size_t have = 0;
+
+    explicit DaemonConnection(int f) : fd(f) {}
+    ~DaemonConnection() { ::close(fd); }
+
+    // 1 = đủ header (+ tên), 0 = chưa đủ, -1 = client đóng / lỗi. Không đọc quá yêu cầu hiện tại.
+    int receiveHead() {
+        for (;;) {
+            size_t need = HUFD_REQUEST_SIZE;
+            if (have >= HUFD_REQUEST_SIZE) {
+                size_t nameLen = head[6] | (head[7] << 8);
+                if (nameLen <= 255) need += nameLen; // Độ dài sai: để worker trả BAD_REQUEST
+            }
+            if (have >= need) return 1;
+            ssize_t n = recv(fd, head + have, need - have, MSG_DONTWAIT);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+            if (n <= 0) return -1;
+            have += n;
+        }
+    }
+};
+
+// ===================== Worker =====================
+// Mỗi worker giữ compressor và buffer riêng qua mọi yêu cầu: sau vài yêu cầu đầu, xử lý 1 yêu cầu
+// không còn cấp phát. Mỗi worker nén tuần tự (1 luồng), song song đến từ nhiều worker phục vụ nhiều
+// kết nối cùng lúc.
+class DaemonWorker {
+public:
+    HuffmanBlockCompressor compressor;
+    vector<byte> input, output;
+
+    DaemonWorker() { compressor.setThreads(1); }
+
+    // Trả về status; outSize là số byte kết quả trong dst
+    uint32_t process(DaemonOp op, span<const byte> src, span<byte> dst, size_t& outSize) {
+        if (op == DAEMON_COMPRESS) {
+            if (dst.size() < compressor.maxCompressedSize(src.size())) return STATUS_NO_SPACE;
+            return compressor.compress(src, dst, outSize) ? STATUS_OK : STATUS_FAILED;
+        }
+        uint64_t rawSize = 0;
+        if (!HuffmanBlockCompressor::decompressedSize(src, rawSize)) return STATUS_FAILED;
+        if (dst.size() < rawSize) return STATUS_NO_SPACE;
+        return compressor.decompress(src, dst, outSize) ? STATUS_OK : STATUS_FAILED;
+    }
+
+    // Dung lượng buffer output cho yêu cầu inline
+    bool outputBound(DaemonOp op, span<const byte> src, size_t& bound) {
+        if (op == DAEMON_COMPRESS) {
+            bound = compressor.maxCompressedSize(src.size());
+            return true;
+        }
+        uint64_t rawSize = 0;
+        if (!HuffmanBlockCompressor::decompressedSize(src, rawSize) || rawSize > HUFD_MAX_INLINE) return false;
+        bound = rawSize;
+        return true;
+    }
+};
+
+HuffmanDaemon::HuffmanDaemon(const string& path, int workers)
+    : socketPath(path), numWorkers(max(1, workers)), listenFd(-1), stopping(false), wakeFd{-1, -1} {}
+
+HuffmanDaemon::~HuffmanDaemon() {
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    for (int fd : wakeFd) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+void HuffmanDaemon::wake() {
+    char one = 1;
+    if (wakeFd[1] >= 0) {
+        ssize_t n = write(wakeFd[1], &one, 1); // Pipe đầy: vòng poll đã có việc để thức dậy
+        (void)n;
+    }
+}
+
+// Gọi được từ signal handler: chỉ đặt cờ và ghi vào pipe
+void HuffmanDaemon::stop() {
+    stopping = true;
+    wake();
+}
+
+void HuffmanDaemon::returnConnection(DaemonConnection* conn) {
+    conn->have = 0;
+    {
+        lock_guard<mutex> lock(returnedMtx);
+        returned.push_back(conn);
+    }
+    wake();
+}
+
+bool HuffmanDaemon::serveRequest(DaemonConnection& conn, DaemonWorker& worker, double startTime) {
+    int fd = conn.fd;
+    const unsigned char* header = conn.head;
+    auto start = steady_clock::now();
+    DaemonOp op = (DaemonOp)header[4];
+    uint8_t transport = header[5];
+    size_t nameLen = header[6] | (header[7] << 8);
+    uint64_t inputSize = getU64(header + 8);
+    uint64_t outputOffset = getU64(header + 16);
+    uint64_t outputCapacity = getU64(header + 24);
+
+    if (memcmp(header, HUFD_MAGIC, 4) != 0 || nameLen > 255 ||
+        (transport == TRANSPORT_INLINE && inputSize > HUFD_MAX_INLINE)) {
+        sendResponse(fd, STATUS_BAD_REQUEST, nullptr, 0, false);
+        return false;
+    }
+    const char* name = reinterpret_cast<const char*>(conn.head + HUFD_REQUEST_SIZE);
+
+    if (op == DAEMON_STATS) {
+        string text = stats.report(nowSeconds() - startTime, numWorkers);
+        stats.record(op, true, 0, 0, 0);
+        return sendResponse(fd, STATUS_OK, text.data(), text.size(), true);
+    }
+    if (op == DAEMON_SHUTDOWN) {
+        sendResponse(fd, STATUS_OK, nullptr, 0, false);
+        stop();
+        return false;
+    }
+    if (op != DAEMON_COMPRESS && op != DAEMON_DECOMPRESS) {
+        sendResponse(fd, STATUS_BAD_REQUEST, nullptr, 0, false);
+        return false;
+    }
+
+    uint32_t status;
+    size_t outSize = 0;
+    if (transport == TRANSPORT_SHM) {
+        SharedRegion region;
+        bool valid = region.open(string(name, nameLen)) && inputSize <= region.size &&
+                     outputOffset >= inputSize && outputOffset <= region.size &&
+                     outputCapacity <= region.size - outputOffset;
+        if (!valid) {
+            status = STATUS_BAD_REQUEST;
+        } else {
+            span<const byte> src(reinterpret_cast<const byte*>(region.base), inputSize);
+            span<byte> dst(reinterpret_cast<byte*>(region.base + outputOffset), outputCapacity);
+            status = worker.process(op, src, dst, outSize);
+        }
+        if (!sendResponse(fd, status, nullptr, status == STATUS_OK ? outSize : 0, false)) return false;
+    } else {
+        worker.input.resize(inputSize);
+        if (!readFullServer(fd, worker.input.data(), inputSize, stopping)) return false;
+        span<const byte> src(worker.input.data(), inputSize);
+        size_t bound = 0;
+        if (worker.outputBound(op, src, bound)) {
+            if (worker.output.size() < bound) worker.output.resize(bound);
+            status = worker.process(op, src, span<byte>(worker.output.data(), bound), outSize);
+        } else {
+            status = STATUS_FAILED;
+        }
+        if (status != STATUS_OK) outSize = 0;
+        if (!sendResponse(fd, status, worker.output.data(), outSize, true)) return false;
+    }
+
+    uint64_t us = duration_cast<microseconds>(steady_clock::now() - start).count();
+    stats.record(op, status == STATUS_OK, inputSize, outSize, us);
+    return true;
+}
+
+static atomic<HuffmanDaemon*> signalTarget(nullptr);
+
+// Chỉ phục vụ tiến trình cùng user với daemon: yêu cầu có thể mở vùng nhớ chia sẻ bất kỳ (shm_open O_RDWR)
+// hoặc tắt daemon. Quyền 0600 của file socket đã chặn user khác; kiểm tra thêm uid của đầu kia phòng khi
+// quyền bị nới (thư mục / file socket do người khác tạo lại).
+static bool peerAllowed(int fd) {
+#if defined(__linux__)
+    ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return false;
+    return cred.uid == geteuid();
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+    uid_t uid;
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) != 0) return false;
+    return uid == geteuid();
+#else
+    (void)fd;
+    return true;
+#endif
+}
+
+static void onSignal(int) {
+    if (HuffmanDaemon* d = signalTarget.load()) d->stop();
+}
+
+bool HuffmanDaemon::run() {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        cerr << "Loi: Duong dan socket qua dai!" << endl;
+        return false;
+    }
+    memcpy(addr.sun_path, socketPath.c_str(), socketPath.size());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str()); // Socket cũ còn sót lại từ lần chạy trước
+    // Socket chỉ user hiện tại kết nối được: umask 077 khi bind để không có lúc nào file socket mở cho
+    // người khác, chmod lại cho chắc trước khi listen
+    mode_t oldMask = umask(0077);
+    bool bound = listenFd >= 0 && bind(listenFd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    umask(oldMask);
+    if (!bound || chmod(socketPath.c_str(), 0600) != 0 || listen(listenFd, 64) != 0) {
+        cerr << "Loi: Khong the tao socket " << socketPath << "!" << endl;
+        return false;
+    }
+
+    signalTarget = this;
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    // Làm nóng trước khi nhận yêu cầu: hiệu chỉnh mô hình song song (đọc cache hoặc đo) và
+    // cấp phát buffer cho mỗi worker
+    double startTime = nowSeconds();
+    vector<DaemonWorker> workers(numWorkers);
+    {
+        string warm(64 * 1024, 'a');
+        for (auto& w : workers) {
+            span<const byte> src(reinterpret_cast<const byte*>(warm.data()), warm.size());
+            w.output.resize(w.compressor.maxCompressedSize(warm.size()));
+            size_t size = 0;
+            w.process(DAEMON_COMPRESS, src, w.output, size);
+        }
+    }
+
+    if (pipe(wakeFd) != 0) {
+        cerr << "Loi: Khong the tao pipe!" << endl;
+        return false;
+    }
+    for (int fd : wakeFd) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    // Hàng đợi kết nối đã nhận đủ header; worker xử lý 1 yêu cầu rồi trả kết nối về vòng poll
+    BoundedQueue<DaemonConnection*> connections(256);
+    vector<thread> pool;
+    for (int i = 0; i < numWorkers; i++) {
+        pool.emplace_back([&, i] {
+            DaemonConnection* conn;
+            while (connections.pop(conn)) {
+                if (serveRequest(*conn, workers[i], startTime) && !stopping) returnConnection(conn);
+                else delete conn;
+            }
+        });
+    }
+
+    cout << "Daemon dang chay tai " << socketPath << " (" << numWorkers << " worker)" << endl;
+
+    // Vòng poll: socket lắng nghe, pipe đánh thức và các kết nối chưa có yêu cầu đầy đủ. Timeout để
+    // kiểm tra cờ dừng.
+    vector<DaemonConnection*> idle;
+    vector<pollfd> fds;
+    while (!stopping) {
+        {
+            lock_guard<mutex> lock(returnedMtx);
+            idle.insert(idle.end(), returned.begin(), returned.end());
+            returned.clear();
+        }
+        fds.assign({{listenFd, POLLIN, 0}, {wakeFd[0], POLLIN, 0}});
+        for (DaemonConnection* conn : idle) fds.push_back({conn->fd, POLLIN, 0});
+        int ready = poll(fds.data(), fds.size(), POLL_INTERVAL_MS);
+        if (ready <= 0) continue;
+
+        if (fds[1].revents) {
+            char drain[64];
+            while (read(wakeFd[0], drain, sizeof(drain)) > 0) {}
+        }
+        size_t kept = 0;
+        for (size_t k = 0; k < idle.size(); k++) {
+            DaemonConnection* conn = idle[k];
+            int state = fds[k + 2].revents ? conn->receiveHead() : 0;
+            if (state > 0) connections.push(conn);
+            else if (state < 0) delete conn;
+            else idle[kept++] = conn;
+        }
+        idle.resize(kept);
+
+        if (!(fds[0].revents & POLLIN)) continue;
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        if (!peerAllowed(fd)) {
+            cerr << "Loi: Tu choi ket noi tu user khac!" << endl;
+            ::close(fd);
+            continue;
+        }
+        // Client không đọc phản hồi: send hết hạn thay vì giữ worker
+        timeval timeout = {DAEMON_STALL_MS / 1000, (DAEMON_STALL_MS % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        idle.push_back(new DaemonConnection(fd));
+    }
+
+    connections.close();
+    for (auto& t : pool) t.join();
+    for (DaemonConnection* conn : idle) delete conn;
+    for (DaemonConnection* conn : returned) delete conn;
+    returned.clear();
+    signalTarget = nullptr;
+
+    cout << "Daemon dung." << endl << stats.report(nowSeconds() - startTime, numWorkers);
+    return true;
+}
+
+// ===================== Client =====================
+
+bool daemonRequest(const string& socketPath, DaemonOp op, const string& input, string& output, bool useShm) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        cerr << "Loi: Khong ket noi duoc daemon tai " << socketPath << "!" << endl;
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+
+    bool shm = useShm && (op == DAEMON_COMPRESS || op == DAEMON_DECOMPRESS);
+    string name;
+    size_t outputCapacity = 0;
+    unsigned char* region = nullptr;
+    size_t regionSize = 0;
+
+    if (shm) {
+        // Dung lượng output: cận trên kích thước nén, hoặc kích thước gốc ghi trong header
+        if (op == DAEMON_COMPRESS) {
+            outputCapacity = HuffmanBlockCompressor().maxCompressedSize(input.size());
+        } else {
+            uint64_t rawSize = 0;
+            span<const byte> src(reinterpret_cast<const byte*>(input.data()), input.size());
+            if (!HuffmanBlockCompressor::decompressedSize(src, rawSize)) {
+                cerr << "Loi: File khong dung dinh dang HUFB!" << endl;
+                ::close(fd);
+                return false;
+            }
+            outputCapacity = rawSize;
+        }
+        static atomic<int> counter(0);
+        name = "/huffman-" + to_string(getpid()) + "-" + to_string(counter++);
+        regionSize = max<size_t>(1, input.size() + outputCapacity);
+        int shmFd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        bool ok = shmFd >= 0 && ftruncate(shmFd, (off_t)regionSize) == 0;
+        void* p = ok ? mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0) : MAP_FAILED;
+        if (shmFd >= 0) ::close(shmFd);
+        if (p == MAP_FAILED) {
+            cerr << "Loi: Khong tao duoc vung nho chia se!" << endl;
+            if (shmFd >= 0) shm_unlink(name.c_str());
+            ::close(fd);
+            return false;
+        }
+        region = (unsigned char*)p;
+        memcpy(region, input.data(), input.size());
+    }
+
+    unsigned char header[HUFD_REQUEST_SIZE] = {0};
+    memcpy(header, HUFD_MAGIC, 4);
+    header[4] = op;
+    header[5] = shm ? TRANSPORT_SHM : TRANSPORT_INLINE;
+    header[6] = (unsigned char)name.size();
+    putU64(header + 8, input.size());
+    putU64(header + 16, input.size());
+    putU64(header + 24, outputCapacity);
+
+    bool ok = writeFull(fd, header, HUFD_REQUEST_SIZE) && writeFull(fd, name.data(), name.size());
+    if (ok && !shm && (op == DAEMON_COMPRESS || op == DAEMON_DECOMPRESS)) ok = writeFull(fd, input.data(), input.size());
+
+    unsigned char response[HUFD_RESPONSE_SIZE];
+    ok = ok && readFull(fd, response, HUFD_RESPONSE_SIZE);
+    uint32_t status = ok ? getU32(response) : STATUS_FAILED;
+    uint64_t size = ok ? getU64(response + 8) : 0;
+    if (ok && status == STATUS_OK) {
+        if (shm) {
+            output.assign(reinterpret_cast<const char*>(region + input.size()), size);
+        } else {
+            output.resize(size);
+            ok = readFull(fd, &output[0], size);
+        }
+    }
+
+    if (region) {
+        munmap(region, regionSize);
+        shm_unlink(name.c_str());
+    }
+    ::close(fd);
+
+    if (!ok) {
+        cerr << "Loi: Mat ket noi voi daemon!" << endl;
+        return false;
+    }
+    if (status != STATUS_OK) {
+        cerr << "Loi: Daemon tra ve ma loi " << status << endl;
+        return false;
+    }
+    return true;
+}
+
+#else
+
+HuffmanDaemon::HuffmanDaemon(const string& path, int workers)
+    : socketPath(path), numWorkers(workers), listenFd(-1), stopping(false), wakeFd{-1, -1} {}
+
+HuffmanDaemon::~HuffmanDaemon() {}
+
+void HuffmanDaemon::stop() {
+    stopping = true;
+}
+
+bool HuffmanDaemon::run() {
+    cerr << "Loi: Che do daemon chi ho tro tren he POSIX!" << endl;
+    return false;
+}
+
+bool daemonRequest(const string&, DaemonOp, const string&, string&, bool) {
+    cerr << "Loi: Che do daemon chi ho tro tren he POSIX!" << endl;
+    return false;
+}
+
+#endif
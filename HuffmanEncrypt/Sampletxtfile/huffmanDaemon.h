@@ -0,0 +1,105 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANDAEMON_H
+#define HUFFMANENCRYPT_HUFFMANDAEMON_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Daemon nén chạy lâu dài, nhận yêu cầu qua Unix domain socket. Tránh chi phí khởi động của mỗi
+// tiến trình mới (runtime OpenMP, cấp phát, hiệu chỉnh mô hình song song): các worker và buffer của
+// chúng luôn sẵn sàng, bảng giải mã được cache theo từng luồng (xem decodeTableCacheStats).
+//
+// Giao thức (số nguyên little-endian):
+//   Yêu cầu  (32 byte): "HUFD" | u8 op | u8 transport | u16 nameLen | u64 inputSize
+//                       | u64 outputOffset | u64 outputCapacity, rồi nameLen byte tên shm,
+//                       rồi inputSize byte dữ liệu nếu transport = inline
+//   Phản hồi (16 byte): u32 status | u32 dự trữ | u64 outputSize, rồi dữ liệu nếu transport = inline
+// Với transport = shm, dữ liệu vào nằm ở đầu vùng nhớ chia sẻ (shm_open) do client tạo, kết quả được
+// ghi vào cùng vùng tại outputOffset (tối đa outputCapacity byte): payload lớn không phải chép qua socket.
+// Socket được tạo với quyền 0600 và daemon chỉ nhận kết nối từ cùng uid (SO_PEERCRED / getpeereid).
+// Worker chỉ giữ kết nối trong lúc xử lý 1 yêu cầu: luồng accept nhận header + tên shm (không chặn) của mọi
+// kết nối rồi mới giao cho worker; client gửi dở payload rồi im lặng quá DAEMON_STALL_MS thì bị ngắt.
+
+const char HUFD_MAGIC[4] = {'H', 'U', 'F', 'D'};
+const size_t HUFD_REQUEST_SIZE = 32;
+const size_t HUFD_RESPONSE_SIZE = 16;
+const uint64_t HUFD_MAX_INLINE = 256ULL << 20; // Giới hạn payload inline (chặn yêu cầu bất thường)
+const int DAEMON_STALL_MS = 5000;               // Client không gửi / nhận thêm byte nào trong 1 yêu cầu
+
+enum DaemonOp : uint8_t {
+    DAEMON_COMPRESS = 1,
+    DAEMON_DECOMPRESS = 2,
+    DAEMON_STATS = 3,     // Phản hồi inline là bảng thống kê dạng văn bản
+    DAEMON_SHUTDOWN = 4,
+};
+
+enum DaemonTransport : uint8_t {
+    TRANSPORT_INLINE = 0,
+    TRANSPORT_SHM = 1,
+};
+
+enum DaemonStatus : uint32_t {
+    STATUS_OK = 0,
+    STATUS_FAILED = 1,        // Dữ liệu hỏng / lỗi nén
+    STATUS_NO_SPACE = 2,      // Vùng output không đủ chỗ
+    STATUS_BAD_REQUEST = 3,
+};
+
+// Thống kê của daemon: số yêu cầu, lưu lượng và phân bố độ trễ (histogram theo lũy thừa 2 của micro giây)
+class DaemonStats {
+private:
+    static const int LATENCY_BUCKETS = 32;
+    std::mutex mtx;
+    uint64_t requests[5] = {0};
+    uint64_t failures = 0;
+    uint64_t bytesIn = 0, bytesOut = 0;
+    uint64_t busyUs = 0;
+    uint64_t latency[LATENCY_BUCKETS] = {0};
+
+    uint64_t percentileUs(double p) const;
+
+public:
+    void record(DaemonOp op, bool ok, uint64_t in, uint64_t out, uint64_t us);
+    std::string report(double uptimeSeconds, int workers);
+};
+
+class DaemonWorker;
+struct DaemonConnection;
+
+class HuffmanDaemon {
+private:
+    std::string socketPath;
+    int numWorkers;
+    int listenFd;
+    std::atomic<bool> stopping;
+    DaemonStats stats;
+    int wakeFd[2];                 // Pipe đánh thức vòng poll khi worker trả kết nối / khi dừng
+    std::mutex returnedMtx;
+    std::vector<DaemonConnection*> returned; // Kết nối worker vừa xử lý xong 1 yêu cầu, chờ vòng poll nhận lại
+
+    // Xử lý đúng 1 yêu cầu (header đã nhận đủ); false = đóng kết nối
+    bool serveRequest(DaemonConnection& conn, DaemonWorker& worker, double startTime);
+    void returnConnection(DaemonConnection* conn);
+    void wake();
+
+public:
+    HuffmanDaemon(const std::string& path, int workers);
+    ~HuffmanDaemon();
+
+    // Chạy đến khi nhận SIGINT / SIGTERM hoặc yêu cầu DAEMON_SHUTDOWN
+    bool run();
+    void stop();
+};
+
+// Client: gửi 1 yêu cầu tới daemon. Với useShm, dữ liệu đi qua vùng nhớ chia sẻ thay vì socket.
+bool daemonRequest(const std::string& socketPath, DaemonOp op, const std::string& input, std::string& output,
+                   bool useShm);
+
+#endif //HUFFMANENCRYPT_HUFFMANDAEMON_H
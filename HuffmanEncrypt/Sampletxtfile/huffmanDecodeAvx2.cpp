@@ -0,0 +1,103 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanBlock.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+// Kernel AVX2: 8 bộ đọc bit nằm trong 8 lane 32-bit, mỗi lane giải mã một luồng.
+// Mỗi bước: gather 4 byte tại vị trí bit của từng lane, đảo byte sang big-endian,
+// dịch theo phần lẻ bit, rồi gather phần tử bảng giải mã.
+// Chỉ được biên dịch với AVX2 qua thuộc tính target, nên không cần cờ -mavx2 cho cả project;
+// hàm chỉ được gọi sau khi cpuHasAvx2() xác nhận.
+// Chuyên biệt theo độ rộng bảng (vị trí cắt chỉ số) và độ dài mã tối đa (số bước chạy liền không kiểm tra biên).
+template <int TableBits, int MaxLen>
+__attribute__((target("avx2")))
+static void decodeStreamsAvx2Impl(const DecodeTable& table, StreamState& state) {
+    // Vị trí bit phải vừa int32 và block cần ít nhất 4 byte để gather an toàn
+    if (state.numStreams != 8 || state.totalBytes < 4 || state.totalBytes >= (1u << 28)) {
+        decodeStreamsScalar(table, state);
+        return;
+    }
+
+    alignas(32) int32_t lanePos[8];
+    for (int j = 0; j < 8; j++) lanePos[j] = (int32_t)state.bitPos[j];
+    __m256i pos = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanePos));
+
+    const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                              3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i seven = _mm256_set1_epi32(7);
+    const __m256i entryMask = _mm256_set1_epi32(0xFFFF);
+    const __m256i symMask = _mm256_set1_epi32(0xFF);
+    const int* base = reinterpret_cast<const int*>(state.base);
+    const int* entries = reinterpret_cast<const int*>(table.entry);
+
+    size_t minCount = state.count[0];
+    for (int j = 1; j < 8; j++) minCount = std::min(minCount, state.count[j]);
+
+    // Bit cuối cùng mà một lần gather 4 byte vẫn nằm trong vùng dữ liệu
+    const int64_t safeLimit = (int64_t)(state.totalBytes - 4) * 8;
+    size_t done = 0;
+
+    while (true) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanePos), pos);
+        int32_t maxPos = lanePos[0];
+        for (int j = 1; j < 8; j++) maxPos = std::max(maxPos, lanePos[j]);
+
+        // Số bước chạy liền không cần kiểm tra biên: mỗi bước tiêu tối đa MaxLen bit
+        int64_t room = safeLimit - maxPos;
+        if (room <= 0) break;
+        size_t steps = std::min<size_t>(minCount - done, (size_t)(room / MaxLen)) & ~(size_t)3;
+        if (steps == 0) break;
+
+        for (size_t s = 0; s < steps; s += 4) {
+            __m256i packed = _mm256_setzero_si256();
+            for (int k = 0; k < 4; k++) {
+                __m256i word = _mm256_i32gather_epi32(base, _mm256_srli_epi32(pos, 3), 1);
+                word = _mm256_shuffle_epi8(word, byteSwap);
+                word = _mm256_sllv_epi32(word, _mm256_and_si256(pos, seven));
+                __m256i idx = _mm256_srli_epi32(word, 32 - TableBits);
+
+                __m256i e = _mm256_and_si256(_mm256_i32gather_epi32(entries, idx, 2), entryMask);
+                pos = _mm256_add_epi32(pos, _mm256_srli_epi32(e, 8));
+                packed = _mm256_or_si256(packed, _mm256_slli_epi32(_mm256_and_si256(e, symMask), 8 * k));
+            }
+
+            // Mỗi lane giữ 4 ký tự liên tiếp của luồng mình -> ghi 4 byte một lần
+            alignas(32) uint32_t out4[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(out4), packed);
+            for (int j = 0; j < 8; j++) memcpy(state.out[j] + done + s, &out4[j], 4);
+        }
+        done += steps;
+    }
+
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanePos), pos);
+    for (int j = 0; j < 8; j++) {
+        state.bitPos[j] = (uint64_t)(uint32_t)lanePos[j];
+        state.out[j] += done;
+        state.count[j] -= done;
+    }
+
+    // Phần còn lại (đuôi các luồng dài hơn, vùng gần cuối block) dùng kernel vô hướng
+    decodeStreamsScalar(table, state);
+}
+
+void decodeStreamsAvx2(const DecodeTable& table, StreamState& state) {
+    switch (table.tableBits) {
+        case 8: decodeStreamsAvx2Impl<8, 8>(table, state); break;
+        case 10: decodeStreamsAvx2Impl<10, 10>(table, state); break;
+        default: decodeStreamsAvx2Impl<HUF_TABLE_BITS, HUF_MAX_CODE_LEN>(table, state); break;
+    }
+}
+
+#else
+
+void decodeStreamsAvx2(const DecodeTable& table, StreamState& state) {
+    decodeStreamsScalar(table, state);
+}
+
+#endif
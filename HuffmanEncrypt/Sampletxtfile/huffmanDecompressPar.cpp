@@ -0,0 +1,444 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanDecompressPar.h"
+#include "huffmanChecksum.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <omp.h>
+
+using namespace std;
+using namespace std::chrono;
+
+// Byte 0 sau luồng bit: đọc 8 byte / đi tiếp trên cây không cần kiểm tra biên. Mã cuối bắt đầu trước
+// totalBits có thể dài tới 255 bit (parseTreeNode giới hạn độ sâu), rồi peekBits đọc thêm 8 byte.
+static const size_t BODY_PADDING = 256 / 8 + 16;
+static const uint64_t MIN_CHUNK_BITS = 1 << 16;
+
+static inline uint64_t peekBits(const unsigned char* body, uint64_t pos) {
+    const unsigned char* p = body + (pos >> 3);
+    uint64_t v = 0;
+    for (int k = 0; k < 8; k++) v = (v << 8) | p[k];
+    return v << (pos & 7);
+}
+
+static inline int bitAt(const unsigned char* body, uint64_t pos) {
+    return (body[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+
+bool HuffmanDecompressorPar::readFreqHeader(const vector<unsigned char>& file, Header& h) const {
+    int rawMapSize = 0;
+    if (file.size() < sizeof(int)) return false;
+    memcpy(&rawMapSize, file.data(), sizeof(int));
+    // Tần suất u64 (có cờ) hoặc int32 (file của bản đầu); bit lạ khác = không phải header này
+    size_t freqSize = (rawMapSize & LEGACY_WIDE_FREQ) ? sizeof(uint64_t) : sizeof(int32_t);
+    bool sampled = (rawMapSize & LEGACY_SAMPLED_FREQ) != 0;
+    int mapSize = rawMapSize & ~(LEGACY_WIDE_FREQ | LEGACY_SAMPLED_FREQ);
+    const size_t entrySize = sizeof(char) + freqSize;
+    size_t countSize = sampled ? sizeof(uint64_t) : 0;
+    if (mapSize < 1 || mapSize > 256 || file.size() < sizeof(int) + mapSize * entrySize + countSize + sizeof(int))
+        return false;
+
+    vector<int> order;
+    const unsigned char* p = file.data() + sizeof(int);
+    for (int i = 0; i < mapSize; i++, p += entrySize) {
+        unsigned char ch = p[0];
+        uint64_t f;
+        if (freqSize == sizeof(uint64_t)) {
+            memcpy(&f, p + 1, sizeof(f));
+        } else {
+            int32_t f32;
+            memcpy(&f32, p + 1, sizeof(f32));
+            if (f32 <= 0) return false;
+            f = (uint64_t)f32;
+        }
+        if (f == 0 || h.freq[ch] != 0) return false; // Mỗi ký tự có mặt đúng 1 lần
+        h.freq[ch] = f;
+        order.push_back(ch);
+    }
+    h.symbolCount = 0;
+    for (int s = 0; s < 256; s++) h.symbolCount += h.freq[s];
+    if (sampled) {
+        memcpy(&h.symbolCount, p, sizeof(h.symbolCount));
+        p += sizeof(h.symbolCount);
+    }
+    int padding;
+    memcpy(&padding, p, sizeof(int));
+    h.bodyOffset = (size_t)(p - file.data()) + sizeof(int);
+    uint64_t bodyBytes = file.size() - h.bodyOffset;
+    if (padding < 0 || padding >= 8 || bodyBytes * 8 < (uint64_t)padding) return false;
+    h.totalBits = bodyBytes * 8 - padding;
+
+    h.knownCount = true;
+    h.histogram = !sampled;
+    h.emptySingleCode = freqSize == sizeof(int32_t);
+    h.leaves = mapSize;
+    h.singleSymbol = order[0];
+    buildTree(h.freq, order, h.tree);
+    return true;
+}
+
+// Nút cây preorder của output.huff; trả về chỉ số nút hoặc -1 nếu cây hỏng. Cây của tối đa 256 ký tự
+// có tối đa 511 nút và không sâu quá 255 mức.
+int HuffmanDecompressorPar::parseTreeNode(const vector<unsigned char>& file, size_t& index, Tree& tree, int depth) {
+    if (index >= file.size() || depth > 255 || tree.symbol.size() >= 511) return -1;
+    int node = (int)tree.symbol.size();
+    tree.child[0].push_back(-1);
+    tree.child[1].push_back(-1);
+    tree.symbol.push_back(0);
+    if (file[index] == '1') {
+        if (index + 1 >= file.size()) return -1;
+        tree.symbol[node] = file[index + 1];
+        index += 2;
+        return node;
+    }
+    if (file[index] != '0') return -1;
+    index++;
+    int left = parseTreeNode(file, index, tree, depth + 1);
+    if (left < 0) return -1;
+    int right = parseTreeNode(file, index, tree, depth + 1);
+    if (right < 0) return -1;
+    tree.child[0][node] = left;
+    tree.child[1][node] = right;
+    return node;
+}
+
+bool HuffmanDecompressorPar::readTreeHeader(const vector<unsigned char>& file, Header& h) const {
+    size_t index;
+    Tree& tree = h.tree;
+    if (file.size() >= 4 && file[1] == '1' && file[3] == '|') {
+        // Cây 1 ký tự: nút gốc chỉ có con trái ("01c"), mã của ký tự là "0"
+        index = 3;
+        tree.child[0].assign(1, -1);
+        tree.child[1].assign(1, -1);
+        tree.symbol.assign(1, file[2]);
+        tree.root = 0;
+        h.leaves = 1;
+        h.singleSymbol = file[2];
+    } else {
+        index = 0;
+        tree.root = parseTreeNode(file, index, tree, 0);
+        if (tree.root < 0 || index >= file.size() || file[index] != '|') return false;
+        for (size_t node = 0; node < tree.symbol.size(); node++) h.leaves += tree.child[0][node] < 0;
+    }
+    computeMinLen(tree);
+
+    // Số bit: u64, hoặc 4 byte (size_t của bản build 32-bit); CRC32C ở cuối nếu có. Chọn theo kích thước file.
+    size_t rest = file.size() - index - 1;
+    for (size_t lengthSize : {sizeof(uint64_t), sizeof(uint32_t)}) {
+        if (rest < lengthSize) continue;
+        uint64_t bitLength = 0;
+        if (lengthSize == sizeof(uint64_t)) {
+            memcpy(&bitLength, file.data() + index + 1, sizeof(uint64_t));
+        } else {
+            uint32_t bitLength32;
+            memcpy(&bitLength32, file.data() + index + 1, sizeof(uint32_t));
+            bitLength = bitLength32;
+        }
+        if (bitLength > (uint64_t)rest * 8) continue;
+        uint64_t withoutTrailer = lengthSize + bitLength / 8 + (bitLength % 8 != 0);
+        h.hasChecksum = rest == withoutTrailer + sizeof(uint32_t);
+        if (!h.hasChecksum && rest != withoutTrailer) continue;
+        if (h.hasChecksum) memcpy(&h.checksum, file.data() + index + 1 + withoutTrailer, sizeof(uint32_t));
+        h.bodyOffset = index + 1 + lengthSize;
+        h.totalBits = bitLength;
+        return true;
+    }
+    return false;
+}
+
+void HuffmanDecompressorPar::buildTree(const uint64_t freq[256], const vector<int>& order, Tree& tree) {
+    // Lá 0..n-1 theo thứ tự header, nút trong thêm vào sau; heap như priority_queue / buildTree của bộ nén
+    size_t n = order.size();
+    vector<uint64_t> weight;
+    tree.child[0].assign(n, -1);
+    tree.child[1].assign(n, -1);
+    tree.symbol.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        weight.push_back(freq[order[i]]);
+        tree.symbol[i] = order[i];
+    }
+
+    auto cmp = [&](int l, int r) { return weight[l] > weight[r]; };
+    vector<int> heap;
+    for (size_t i = 0; i < n; i++) {
+        heap.push_back((int)i);
+        push_heap(heap.begin(), heap.end(), cmp);
+    }
+    while (heap.size() != 1) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        int left = heap.back(); heap.pop_back();
+        pop_heap(heap.begin(), heap.end(), cmp);
+        int right = heap.back(); heap.pop_back();
+
+        weight.push_back(weight[left] + weight[right]);
+        tree.child[0].push_back(left);
+        tree.child[1].push_back(right);
+        tree.symbol.push_back(0);
+        heap.push_back((int)weight.size() - 1);
+        push_heap(heap.begin(), heap.end(), cmp);
+    }
+    tree.root = heap.front();
+    computeMinLen(tree);
+}
+
+// Độ dài mã ngắn nhất: duyệt theo chiều rộng tới lá đầu tiên
+void HuffmanDecompressorPar::computeMinLen(Tree& tree) {
+    vector<int> level = {tree.root};
+    tree.minLen = 0;
+    while (!level.empty() && tree.child[0][level[0]] >= 0) {
+        bool leafFound = false;
+        vector<int> next;
+        for (int node : level) {
+            if (tree.child[0][node] < 0) leafFound = true;
+            else next.insert(next.end(), {tree.child[0][node], tree.child[1][node]});
+        }
+        if (leafFound) break;
+        level.swap(next);
+        tree.minLen++;
+    }
+    tree.minLen = max(tree.minLen, 1);
+}
+
+void HuffmanDecompressorPar::buildDecodeTable(const Tree& tree, vector<DecodeEntry>& table) {
+    table.assign(1 << DECODE_BITS, DecodeEntry());
+    for (uint32_t prefix = 0; prefix < table.size(); prefix++) {
+        int node = tree.root;
+        int length = 0;
+        while (tree.child[0][node] >= 0 && length < DECODE_BITS) {
+            node = tree.child[(prefix >> (DECODE_BITS - 1 - length)) & 1][node];
+            length++;
+        }
+        bool leaf = tree.child[0][node] < 0;
+        table[prefix] = {(uint16_t)(leaf ? tree.symbol[node] : node), (uint8_t)length, (uint8_t)leaf};
+    }
+}
+
+// Giải mã từ bit pos cho tới khi vị trí >= stop (mã cuối có thể vượt stop). marks != nullptr: ghi lại vị trí
+// bắt đầu của tối đa SYNC_MARKS mã đầu tiên. Trả về vị trí sau mã cuối cùng.
+uint64_t HuffmanDecompressorPar::decodeRange(const Tree& tree, const DecodeEntry* table, const unsigned char* body,
+                                             uint64_t pos, uint64_t stop, unsigned char* out, size_t& count,
+                                             vector<uint64_t>* marks) {
+    size_t n = 0;
+    auto decodeOne = [&] {
+        const DecodeEntry& e = table[peekBits(body, pos) >> (64 - DECODE_BITS)];
+        pos += e.length;
+        if (e.leaf) {
+            out[n++] = (unsigned char)e.value;
+            return;
+        }
+        // Mã dài hơn DECODE_BITS bit: đi tiếp trên cây từng bit
+        int node = e.value;
+        while (tree.child[0][node] >= 0) node = tree.child[bitAt(body, pos++)][node];
+        out[n++] = (unsigned char)tree.symbol[node];
+    };
+
+    if (marks) {
+        while (pos < stop && marks->size() < SYNC_MARKS) {
+            marks->push_back(pos);
+            decodeOne();
+        }
+    }
+    while (pos < stop) decodeOne();
+    count = n;
+    return pos;
+}
+
+bool HuffmanDecompressorPar::decompress(const string& inputFilePath, const string& outputFilePath) {
+    cout << "--- BAT DAU GIAI NEN FILE CU (SONG SONG - SPECULATIVE) ---" << endl;
+    cout << "Input:  " << inputFilePath << endl;
+    if (!outputFilePath.empty()) cout << "Output: " << outputFilePath << endl;
+    cout << endl;
+
+    // --- BƯỚC 1: ĐỌC FILE, HEADER VÀ DỰNG LẠI CÂY ---
+    auto start = high_resolution_clock::now();
+    ifstream inFile(inputFilePath, ios::binary | ios::ate);
+    if (!inFile) {
+        cerr << "Loi: Khong the mo file input!" << endl;
+        return false;
+    }
+    size_t fileSize = (size_t)inFile.tellg();
+    inFile.seekg(0);
+    vector<unsigned char> file(fileSize + BODY_PADDING, 0);
+    inFile.read(reinterpret_cast<char*>(file.data()), fileSize);
+    file.resize(fileSize);
+    if (!inFile) {
+        cerr << "Loi: Khong doc duoc file input!" << endl;
+        return false;
+    }
+
+    // output.huff của demo bắt đầu bằng nút gốc "00" / "01"; mapSize (1-256, cờ ở bit cao) không thể như vậy
+    Header header;
+    bool treeLayout = fileSize >= 2 && file[0] == '0' && (file[1] == '0' || file[1] == '1');
+    if (!(treeLayout ? readTreeHeader(file, header) : readFreqHeader(file, header))) {
+        cerr << "Loi: File khong dung dinh dang nen cu (header hong)!" << endl;
+        return false;
+    }
+    uint64_t totalBits = header.totalBits;
+    file.resize(fileSize + BODY_PADDING, 0); // Trong capacity sẵn có: không cấp phát lại
+    const unsigned char* body = file.data() + header.bodyOffset;
+    const Tree& tree = header.tree;
+
+    vector<DecodeEntry> table;
+    buildDecodeTable(tree, table);
+    auto end = high_resolution_clock::now();
+    cout << "[1] Doc file & dung lai cay: " << duration_cast<microseconds>(end - start).count() << " us ("
+         << header.leaves << " ky tu khac nhau, ";
+    if (header.knownCount) cout << header.symbolCount << " ky tu, ";
+    cout << totalBits << " bit)" << endl;
+
+    vector<unsigned char> output;
+    if (header.leaves == 1) {
+        // Cây 1 lá: mỗi ký tự là 1 bit '0'. Bản đầu gán mã rỗng cho ký tự duy nhất: luồng bit trống.
+        uint64_t count = header.knownCount ? header.symbolCount : totalBits;
+        bool emptyCode = header.emptySingleCode && totalBits == 0;
+        bool zeros = true;
+        for (uint64_t i = 0; i < (totalBits + 7) / 8; i++) zeros &= body[i] == 0;
+        if ((totalBits != count && !emptyCode) || !zeros) {
+            cerr << "Loi: Du lieu nen bi hong!" << endl;
+            return false;
+        }
+        // Số ký tự lấy từ header (không có bit nào để đối chiếu): kiểm tra bằng bảng tần suất ở dưới
+        output.assign(count, (unsigned char)header.singleSymbol);
+    } else {
+        // --- BƯỚC 2: GIẢI MÃ ĐOÁN TỪNG ĐOẠN (SONG SONG) ---
+        start = high_resolution_clock::now();
+        int numThreads = threadOverride > 0 ? threadOverride : omp_get_max_threads();
+        uint64_t numChunks = min<uint64_t>((uint64_t)numThreads * 4, max<uint64_t>(1, totalBits / MIN_CHUNK_BITS));
+        vector<Chunk> chunks(numChunks);
+        for (uint64_t i = 0; i < numChunks; i++) {
+            chunks[i].begin = totalBits * i / numChunks;
+            chunks[i].end = totalBits * (i + 1) / numChunks;
+        }
+
+        #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+        for (long long i = 0; i < (long long)numChunks; i++) {
+            Chunk& c = chunks[i];
+            c.out.resize((c.end - c.begin) / tree.minLen + 1);
+            c.exit = decodeRange(tree, table.data(), body, c.begin, c.end, c.out.data(), c.count, &c.marks);
+        }
+        end = high_resolution_clock::now();
+        cout << "[2] Giai ma doan (song song, speculative): " << duration_cast<microseconds>(end - start).count()
+             << " us (" << numChunks << " doan, " << numThreads << " luong)" << endl;
+
+        // --- BƯỚC 3: ĐỒNG BỘ VÀ SỬA (TUẦN TỰ) ---
+        // Vị trí đúng đầu đoạn i là nơi giải mã đúng của đoạn i - 1 ra khỏi đoạn đó. Giải mã lại từ đó cho tới khi
+        // gặp 1 vị trí đã ghi ở lượt đoán: từ đó 2 lượt giải mã trùng nhau và vị trí ra khỏi đoạn cũng trùng.
+        start = high_resolution_clock::now();
+        uint64_t pos = 0;
+        uint64_t syncedAtStart = 0, redecoded = 0, fallbacks = 0;
+        unsigned char one[1];
+        for (Chunk& c : chunks) {
+            bool listComplete = c.marks.size() == c.count;
+            size_t k = 0;
+            bool synced = false;
+            for (;;) {
+                while (k < c.marks.size() && c.marks[k] < pos) k++;
+                if (k < c.marks.size() && c.marks[k] == pos) {
+                    synced = true;
+                    break;
+                }
+                if (pos >= c.end || (k == c.marks.size() && !listComplete)) break;
+                size_t n;
+                pos = decodeRange(tree, table.data(), body, pos, pos + 1, one, n, nullptr);
+                c.fix.push_back(one[0]);
+            }
+
+            if (synced) {
+                c.syncIndex = k;
+                pos = c.exit;
+                syncedAtStart += k == 0;
+            } else {
+                c.syncIndex = c.count;
+                if (pos < c.end) {
+                    // Không gặp vị trí nào trong các mốc đã ghi: giải mã tuần tự phần còn lại của đoạn
+                    size_t before = c.fix.size(), n;
+                    c.fix.resize(before + (c.end - pos) / tree.minLen + 1);
+                    pos = decodeRange(tree, table.data(), body, pos, c.end, c.fix.data() + before, n, nullptr);
+                    c.fix.resize(before + n);
+                    fallbacks++;
+                }
+            }
+            redecoded += c.fix.size();
+        }
+        end = high_resolution_clock::now();
+        cout << "[3] Dong bo & sua (tuan tu): " << duration_cast<microseconds>(end - start).count() << " us ("
+             << syncedAtStart << " / " << numChunks << " doan dung ngay, giai lai " << redecoded << " ky tu, "
+             << fallbacks << " doan giai tuan tu)" << endl;
+
+        uint64_t produced = 0;
+        for (Chunk& c : chunks) {
+            c.outputOffset = produced;
+            produced += c.fix.size() + (c.count - c.syncIndex);
+        }
+        if (pos != totalBits || (header.knownCount && produced != header.symbolCount)) {
+            cerr << "Loi: Du lieu nen bi hong (so bit / so ky tu khong khop header)!" << endl;
+            return false;
+        }
+        // Cấp phát sau khi đã biết số ký tự thật: header hỏng không làm cấp phát quá lớn
+        output.resize(produced);
+
+        // --- BƯỚC 4: GHÉP CÁC ĐOẠN (SONG SONG) ---
+        start = high_resolution_clock::now();
+        #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+        for (long long i = 0; i < (long long)numChunks; i++) {
+            Chunk& c = chunks[i];
+            unsigned char* dst = output.data() + c.outputOffset;
+            if (!c.fix.empty()) memcpy(dst, c.fix.data(), c.fix.size());
+            if (c.count > c.syncIndex) memcpy(dst + c.fix.size(), c.out.data() + c.syncIndex, c.count - c.syncIndex);
+            vector<unsigned char>().swap(c.out);
+        }
+        end = high_resolution_clock::now();
+        cout << "[4] Ghep cac doan (song song): " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    }
+
+    // Bố cục có bảng tần suất không có checksum: tần suất từng ký tự của kết quả phải khớp header.
+    // Bảng lấy mẫu (mức Fast) không phải tần suất thật: chỉ kiểm tra được số bit và số ký tự ở trên.
+    // output.huff: CRC32C ở cuối file nếu có (bản đầu không ghi).
+    if (header.hasChecksum) {
+        if (crc32c(0, output.data(), output.size()) != header.checksum) {
+            cerr << "Loi: CRC32C sau giai nen khong khop!" << endl;
+            return false;
+        }
+        cout << "    CRC32C khop" << endl;
+    } else if (treeLayout) {
+        cout << "    File khong co CRC32C: chi kiem tra duoc so bit" << endl;
+    } else if (!header.histogram) {
+        cout << "    Bang tan suat lay mau (muc Fast): bo qua kiem tra tan suat" << endl;
+    } else {
+        uint64_t counted[256] = {0};
+        #pragma omp parallel
+        {
+            uint64_t local[256] = {0};
+            #pragma omp for schedule(static)
+            for (long long i = 0; i < (long long)output.size(); i++) local[output[i]]++;
+            #pragma omp critical
+            for (int s = 0; s < 256; s++) counted[s] += local[s];
+        }
+        if (memcmp(counted, header.freq, sizeof(counted)) != 0) {
+            cerr << "Loi: Tan suat ky tu sau giai nen khong khop header!" << endl;
+            return false;
+        }
+        cout << "    Tan suat ky tu khop header" << endl;
+    }
+
+    // --- BƯỚC 5: GHI FILE ---
+    if (!outputFilePath.empty()) {
+        start = high_resolution_clock::now();
+        ofstream outFile(outputFilePath, ios::binary);
+        outFile.write(reinterpret_cast<const char*>(output.data()), (streamsize)output.size());
+        outFile.close();
+        if (!outFile) {
+            cerr << "Loi: Khong the ghi file output!" << endl;
+            return false;
+        }
+        end = high_resolution_clock::now();
+        cout << "[5] Ghi file Output: " << duration_cast<microseconds>(end - start).count() << " us" << endl;
+    }
+    cout << "----------------------------------------------" << endl;
+    return true;
+}
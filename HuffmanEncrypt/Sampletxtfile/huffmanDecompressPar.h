@@ -0,0 +1,98 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANDECOMPRESSPAR_H
+#define HUFFMANENCRYPT_HUFFMANDECOMPRESSPAR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "huffmanCommon.h"
+
+// Giải nén song song file định dạng cũ, 1 luồng bit duy nhất (bit cao trước):
+//   - HuffmanCompressor / HuffmanCompressorPar: int mapSize | mapSize x (char, tần suất) | int padding | bit
+//     Tần suất u64 khi mapSize có cờ LEGACY_WIDE_FREQ, int32 với file của bản đầu. Cờ LEGACY_SAMPLED_FREQ
+//     (mức Fast): bảng là bảng mẫu, theo sau là u64 số ký tự.
+//   - output.huff của chương trình demo (main.cpp ở thư mục gốc): cây preorder ('0' = nút trong,
+//     '1' + ký tự = lá) | '|' | số bit (u64, hoặc 4 byte với bản build 32-bit của bản đầu) | bit
+//     | CRC32C của dữ liệu gốc (có thể không có). File bắt đầu bằng "00" / "01" là bố cục này: byte thứ 2
+//     của mapSize chỉ là 0 hoặc 1.
+// File không có chỉ mục vị trí nên luồng bit được chia đều theo bit, mỗi luồng giải mã đoán (speculative)
+// từ đầu đoạn của mình như thể đó là ranh giới mã. Mã Huffman tự đồng bộ: giải mã từ sai vị trí thường
+// trùng lại ranh giới mã đúng sau vài ký tự, từ đó kết quả giống hệt. Bước sửa (tuần tự, rẻ) giải mã lại
+// từ vị trí kết thúc đúng của đoạn trước cho tới khi gặp 1 ranh giới đã ghi lại của lượt đoán, rồi
+// các đoạn được ghép song song. Kết quả được đối chiếu với bảng tần suất trong header, hoặc với CRC32C
+// ở cuối output.huff nếu có.
+class HuffmanDecompressorPar {
+private:
+    // Cây dựng lại đúng như lúc nén: các nút được đẩy vào heap theo thứ tự trong header,
+    // giống cả 2 engine (engine tuần tự ghi header theo thứ tự map, engine song song theo mã byte)
+    struct Tree {
+        std::vector<int> child[2]; // Nút trong: chỉ số 2 con; lá: -1
+        std::vector<int> symbol;   // Lá: ký tự
+        int root = 0;
+        int minLen = 0;            // Độ dài mã ngắn nhất (cận trên số ký tự của 1 đoạn)
+    };
+
+    // Bảng tra DECODE_BITS bit đầu: lá (ký tự + độ dài mã) hoặc nút trong đạt được sau DECODE_BITS bit
+    struct DecodeEntry {
+        uint16_t value;
+        uint8_t length;
+        uint8_t leaf;
+    };
+    static const int DECODE_BITS = 11;
+
+    // Kết quả của 1 đoạn sau lượt đoán: các ký tự, vị trí bit bắt đầu của các mã đầu tiên và vị trí ra khỏi đoạn
+    struct Chunk {
+        uint64_t begin = 0, end = 0;     // [begin, end) theo bit
+        std::vector<unsigned char> out;  // Ký tự giải mã được từ begin
+        size_t count = 0;
+        std::vector<uint64_t> marks;     // Vị trí các mã đầu tiên (tối đa SYNC_MARKS)
+        uint64_t exit = 0;               // Vị trí đầu mã đầu tiên >= end
+
+        // Sau bước sửa
+        std::vector<unsigned char> fix; // Ký tự giải mã lại từ vị trí đúng tới điểm đồng bộ
+        size_t syncIndex = 0;            // Dùng out[syncIndex, count)
+        size_t outputOffset = 0;
+    };
+    static const size_t SYNC_MARKS = 4096;
+
+    // Header đã đọc, chung cho mọi bố cục
+    struct Header {
+        Tree tree;
+        int leaves = 0;               // Số ký tự khác nhau
+        int singleSymbol = 0;         // Cây 1 lá: ký tự đó
+        bool knownCount = false;      // Biết trước số ký tự (bố cục có bảng tần suất)
+        uint64_t symbolCount = 0;
+        bool histogram = false;       // freq là tần suất thật (không phải bảng mẫu): kiểm tra lại sau khi giải mã
+        bool emptySingleCode = false; // Bản đầu: cây 1 lá có mã rỗng, luồng bit trống
+        uint64_t freq[256] = {0};
+        bool hasChecksum = false;     // output.huff có CRC32C ở cuối
+        uint32_t checksum = 0;
+        size_t bodyOffset = 0;
+        uint64_t totalBits = 0;
+    };
+
+    int threadOverride;
+
+    bool readFreqHeader(const std::vector<unsigned char>& file, Header& header) const;
+    bool readTreeHeader(const std::vector<unsigned char>& file, Header& header) const;
+    static int parseTreeNode(const std::vector<unsigned char>& file, size_t& index, Tree& tree, int depth);
+    static void buildTree(const uint64_t freq[256], const std::vector<int>& order, Tree& tree);
+    static void computeMinLen(Tree& tree);
+    static void buildDecodeTable(const Tree& tree, std::vector<DecodeEntry>& table);
+    static uint64_t decodeRange(const Tree& tree, const DecodeEntry* table, const unsigned char* body, uint64_t pos,
+                                uint64_t stop, unsigned char* out, size_t& count, std::vector<uint64_t>* marks);
+
+public:
+    HuffmanDecompressorPar() : threadOverride(0) {}
+
+    // Ép số luồng (0 = mọi lõi)
+    void setThreads(int threads) { threadOverride = threads; }
+
+    // outputFilePath rỗng: chỉ giải mã và kiểm tra, không ghi file
+    bool decompress(const std::string& inputFilePath, const std::string& outputFilePath);
+};
+
+#endif //HUFFMANENCRYPT_HUFFMANDECOMPRESSPAR_H
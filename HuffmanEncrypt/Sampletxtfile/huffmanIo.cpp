@@ -0,0 +1,383 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanIo.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fstream>
+// Windows không có pread / pwrite: dùng lseek + read / write (backend đồng bộ chỉ chạy trên 1 luồng)
+static long long preadCompat(int fd, void* buf, size_t len, uint64_t offset) {
+    if (_lseeki64(fd, (long long)offset, SEEK_SET) < 0) return -errno;
+    int n = _read(fd, buf, (unsigned)len);
+    return n < 0 ? -errno : n;
+}
+static long long pwriteCompat(int fd, const void* buf, size_t len, uint64_t offset) {
+    if (_lseeki64(fd, (long long)offset, SEEK_SET) < 0) return -errno;
+    int n = _write(fd, buf, (unsigned)len);
+    return n < 0 ? -errno : n;
+}
+static int openRead(const std::string& path) { return _open(path.c_str(), _O_RDONLY | _O_BINARY); }
+static int openWrite(const std::string& path) {
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+static void closeFd(int fd) { _close(fd); }
+static long long fileSizeOf(int fd) {
+    struct _stat64 st;
+    return _fstat64(fd, &st) == 0 ? st.st_size : -1;
+}
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+static long long preadCompat(int fd, void* buf, size_t len, uint64_t offset) {
+    ssize_t n = pread(fd, buf, len, (off_t)offset);
+    return n < 0 ? -errno : n;
+}
+static long long pwriteCompat(int fd, const void* buf, size_t len, uint64_t offset) {
+    ssize_t n = pwrite(fd, buf, len, (off_t)offset);
+    return n < 0 ? -errno : n;
+}
+static int openRead(const std::string& path) { return open(path.c_str(), O_RDONLY); }
+static int openWrite(const std::string& path) { return open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644); }
+static void closeFd(int fd) { close(fd); }
+static long long fileSizeOf(int fd) {
+    struct stat st;
+    return fstat(fd, &st) == 0 ? (long long)st.st_size : -1;
+}
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HUFFMAN_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+using namespace std;
+
+// ===================== Backend đồng bộ (pread / pwrite) =====================
+// Thực hiện yêu cầu ngay khi submit, kết quả được xếp hàng để waitCompletion trả về.
+class SyncIoBackend : public IoBackend {
+private:
+    deque<pair<uint64_t, long long>> completed;
+
+public:
+    const char* name() const override { return "pread/pwrite"; }
+    unsigned queueDepth() const override { return 1; }
+
+    bool submitRead(int fd, void* buf, size_t len, uint64_t offset, uint64_t tag) override {
+        completed.emplace_back(tag, preadCompat(fd, buf, len, offset));
+        return true;
+    }
+
+    bool submitWrite(int fd, const void* buf, size_t len, uint64_t offset, uint64_t tag) override {
+        completed.emplace_back(tag, pwriteCompat(fd, buf, len, offset));
+        return true;
+    }
+
+    bool waitCompletion(uint64_t& tag, long long& result) override {
+        if (completed.empty()) return false;
+        tag = completed.front().first;
+        result = completed.front().second;
+        completed.pop_front();
+        return true;
+    }
+};
+
+#ifdef HUFFMAN_HAVE_IO_URING
+// ===================== Backend io_uring =====================
+// Dùng trực tiếp syscall io_uring_setup / io_uring_enter (không phụ thuộc liburing).
+// Các yêu cầu được ghi vào submission ring và chỉ gửi cho kernel khi cần chờ kết quả,
+// nên nhiều yêu cầu được gửi trong 1 lần syscall.
+class IoUringBackend : public IoBackend {
+private:
+    int ringFd = -1;
+    unsigned depth = 0;
+    unsigned toSubmit = 0;
+
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+    io_uring_cqe* cqes;
+
+    // iovec phải tồn tại đến khi yêu cầu hoàn tất: mỗi yêu cầu giữ 1 slot
+    vector<iovec> iovecs;
+    vector<uint64_t> slotTag;
+    vector<unsigned> freeSlots;
+
+    bool submit(int opcode, int fd, void* buf, size_t len, uint64_t offset, uint64_t tag) {
+        if (freeSlots.empty()) return false;
+        unsigned slot = freeSlots.back();
+        freeSlots.pop_back();
+        iovecs[slot].iov_base = buf;
+        iovecs[slot].iov_len = len;
+        slotTag[slot] = tag;
+
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = (uint8_t)opcode;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t)(uintptr_t)&iovecs[slot];
+        sqe->len = 1;
+        sqe->off = offset;
+        sqe->user_data = slot;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        toSubmit++;
+        return true;
+    }
+
+public:
+    ~IoUringBackend() override {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+        if (ringFd >= 0) close(ringFd);
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ringFd = (int)syscall(__NR_io_uring_setup, entries, &params);
+        if (ringFd < 0) return false;
+
+        depth = params.sq_entries;
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) return false;
+        cqRing = singleMmap ? sqRing
+                            : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) return false;
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*)mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+
+        char* sq = (char*)sqRing;
+        char* cq = (char*)cqRing;
+        sqHead = (unsigned*)(sq + params.sq_off.head);
+        sqTail = (unsigned*)(sq + params.sq_off.tail);
+        sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+        sqArray = (unsigned*)(sq + params.sq_off.array);
+        cqHead = (unsigned*)(cq + params.cq_off.head);
+        cqTail = (unsigned*)(cq + params.cq_off.tail);
+        cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+        iovecs.resize(depth);
+        slotTag.resize(depth);
+        for (unsigned s = 0; s < depth; s++) freeSlots.push_back(depth - 1 - s);
+        return true;
+    }
+
+    const char* name() const override { return "io_uring"; }
+    unsigned queueDepth() const override { return depth; }
+
+    bool submitRead(int fd, void* buf, size_t len, uint64_t offset, uint64_t tag) override {
+        return submit(IORING_OP_READV, fd, buf, len, offset, tag);
+    }
+
+    bool submitWrite(int fd, const void* buf, size_t len, uint64_t offset, uint64_t tag) override {
+        return submit(IORING_OP_WRITEV, fd, const_cast<void*>(buf), len, offset, tag);
+    }
+
+    bool waitCompletion(uint64_t& tag, long long& result) override {
+        if (freeSlots.size() == depth) return false; // Không còn yêu cầu nào đang chờ
+
+        unsigned head = *cqHead;
+        while (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            int ret = (int)syscall(__NR_io_uring_enter, ringFd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            toSubmit -= min<unsigned>(toSubmit, (unsigned)ret);
+        }
+
+        io_uring_cqe* cqe = &cqes[head & *cqMask];
+        unsigned slot = (unsigned)cqe->user_data;
+        result = cqe->res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+
+        tag = slotTag[slot];
+        freeSlots.push_back(slot);
+        return true;
+    }
+};
+#endif
+
+unique_ptr<IoBackend> createIoBackend(IoBackendKind kind, unsigned queueDepth) {
+#ifdef HUFFMAN_HAVE_IO_URING
+    if (kind != IoBackendKind::Sync) {
+        unique_ptr<IoUringBackend> ring(new IoUringBackend());
+        if (ring->init(queueDepth)) return ring;
+    }
+#endif
+    (void)queueDepth;
+    return unique_ptr<IoBackend>(new SyncIoBackend());
+}
+
+// Một yêu cầu đọc / ghi: chuyển lại phần còn thiếu nếu kernel trả về ít byte hơn yêu cầu
+struct IoRequest {
+    unsigned char* data;
+    size_t remaining;
+    uint64_t offset;
+};
+
+static bool runRequests(IoBackend& io, int fd, vector<IoRequest>& requests, bool write) {
+    size_t next = 0, inFlight = 0;
+    bool ok = true;
+
+    auto issue = [&](size_t idx) {
+        IoRequest& r = requests[idx];
+        bool submitted = write ? io.submitWrite(fd, r.data, r.remaining, r.offset, idx)
+                               : io.submitRead(fd, r.data, r.remaining, r.offset, idx);
+        if (submitted) inFlight++;
+        return submitted;
+    };
+
+    while (ok && (next < requests.size() || inFlight > 0)) {
+        while (next < requests.size() && inFlight < io.queueDepth()) {
+            if (!issue(next)) break;
+            next++;
+        }
+
+        uint64_t tag;
+        long long result;
+        if (!io.waitCompletion(tag, result)) {
+            ok = false;
+            break;
+        }
+        inFlight--;
+
+        IoRequest& r = requests[tag];
+        if (result == -EINTR || result == -EAGAIN) result = 0;
+        else if (result <= 0) {
+            ok = false; // Lỗi I/O hoặc file ngắn hơn dự kiến
+            break;
+        }
+        r.data += result;
+        r.offset += result;
+        r.remaining -= (size_t)result;
+        if (r.remaining > 0 && !issue(tag)) ok = false;
+    }
+
+    // Chờ các yêu cầu còn lại xong trước khi buffer bị giải phóng
+    uint64_t tag;
+    long long result;
+    while (inFlight > 0 && io.waitCompletion(tag, result)) inFlight--;
+    return ok;
+}
+
+bool readFileAsync(IoBackend& io, const string& path, string& content) {
+    int fd = openRead(path);
+    if (fd < 0) return false;
+
+    long long size = fileSizeOf(fd);
+    if (size < 0) {
+        closeFd(fd);
+        return false;
+    }
+    content.resize((size_t)size);
+
+    vector<IoRequest> requests;
+    unsigned char* base = reinterpret_cast<unsigned char*>(&content[0]);
+    for (size_t off = 0; off < (size_t)size; off += IO_CHUNK_SIZE)
+        requests.push_back({base + off, min(IO_CHUNK_SIZE, (size_t)size - off), off});
+
+    bool ok = runRequests(io, fd, requests, false);
+    closeFd(fd);
+    return ok;
+}
+
+bool writeFileAsync(IoBackend& io, const string& path, const vector<IoSlice>& slices) {
+    int fd = openWrite(path);
+    if (fd < 0) return false;
+
+    vector<IoRequest> requests;
+    uint64_t offset = 0;
+    for (const IoSlice& s : slices) {
+        unsigned char* p = (unsigned char*)s.data;
+        for (size_t off = 0; off < s.size; off += IO_CHUNK_SIZE) {
+            size_t len = min(IO_CHUNK_SIZE, s.size - off);
+            requests.push_back({p + off, len, offset});
+            offset += len;
+        }
+    }
+
+    bool ok = runRequests(io, fd, requests, true);
+    closeFd(fd);
+    return ok;
+}
+
+#ifndef _WIN32
+bool MappedOutputFile::create(const string& filePath, size_t size) {
+    close();
+    path = filePath;
+    fd = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    length = size;
+    if (size == 0) return true;
+
+    // fallocate cấp phát trước các block đĩa (tránh SIGBUS khi hết chỗ lúc đang ghi vào vùng ánh xạ);
+    // hệ file không hỗ trợ thì chỉ đặt kích thước bằng ftruncate
+#if defined(__linux__)
+    int err = posix_fallocate(fd, 0, (off_t)size);
+    if (err != 0 && err != EOPNOTSUPP && err != EINVAL) return false;
+#endif
+    if (ftruncate(fd, (off_t)size) != 0) return false;
+
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return false;
+    base = (unsigned char*)p;
+    return true;
+}
+
+bool MappedOutputFile::close() {
+    bool ok = true;
+    if (base) {
+        ok = munmap(base, length) == 0;
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ok = (::close(fd) == 0) && ok;
+        fd = -1;
+    }
+    return ok;
+}
+#else
+bool MappedOutputFile::create(const string& filePath, size_t size) {
+    close();
+    path = filePath;
+    length = size;
+    fallback.assign(size, 0);
+    base = fallback.data();
+    fd = 0;
+    return true;
+}
+
+bool MappedOutputFile::close() {
+    if (fd < 0) return true;
+    ofstream out(path, ios::binary);
+    out.write(reinterpret_cast<const char*>(fallback.data()), fallback.size());
+    fallback.clear();
+    base = nullptr;
+    fd = -1;
+    return (bool)out;
+}
+#endif
@@ -0,0 +1,78 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANIO_H
+#define HUFFMANENCRYPT_HUFFMANIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Lớp trừu tượng I/O cho file nén / giải nén. Backend io_uring giữ nhiều yêu cầu đọc / ghi
+// đồng thời (queue depth > 1) để khai thác hết băng thông NVMe; backend đồng bộ dùng
+// pread / pwrite và là phương án dự phòng khi io_uring không có (kernel cũ, seccomp, hệ điều hành khác).
+
+enum class IoBackendKind { Auto, IoUring, Sync };
+
+const size_t IO_CHUNK_SIZE = 1 << 20;   // Mỗi yêu cầu đọc / ghi tối đa 1 MB
+const unsigned IO_QUEUE_DEPTH = 32;     // Số yêu cầu tối đa đang chờ
+
+class IoBackend {
+public:
+    virtual ~IoBackend() {}
+    virtual const char* name() const = 0;
+    virtual unsigned queueDepth() const = 0;
+
+    // Gửi yêu cầu; tag dùng để nhận diện yêu cầu khi hoàn tất.
+    // Gọi tối đa queueDepth() lần trước khi phải chờ hoàn tất.
+    virtual bool submitRead(int fd, void* buf, size_t len, uint64_t offset, uint64_t tag) = 0;
+    virtual bool submitWrite(int fd, const void* buf, size_t len, uint64_t offset, uint64_t tag) = 0;
+    // Chờ 1 yêu cầu hoàn tất. result là số byte đã chuyển, âm là mã lỗi (-errno).
+    virtual bool waitCompletion(uint64_t& tag, long long& result) = 0;
+};
+
+// Tạo backend: Auto thử io_uring trước rồi lùi về pread / pwrite
+std::unique_ptr<IoBackend> createIoBackend(IoBackendKind kind, unsigned queueDepth = IO_QUEUE_DEPTH);
+
+// Một đoạn dữ liệu cần ghi liên tiếp vào file
+struct IoSlice {
+    const void* data;
+    size_t size;
+};
+
+// Đọc toàn bộ file / ghi các đoạn liên tiếp thành 1 file, chia thành các yêu cầu IO_CHUNK_SIZE
+// và giữ tối đa queueDepth() yêu cầu đang chờ.
+bool readFileAsync(IoBackend& io, const std::string& path, std::string& content);
+bool writeFileAsync(IoBackend& io, const std::string& path, const std::vector<IoSlice>& slices);
+
+// Chế độ ghi output: Stream ghi các buffer đã mã hóa ra file, Mmap cấp phát trước file
+// đúng kích thước nén (đã tính chính xác từ bảng mã) và mã hóa thẳng vào vùng ánh xạ.
+enum class OutputMode { Stream, Mmap };
+
+// File output được cấp phát trước (fallocate) và ánh xạ vào bộ nhớ để các luồng ghi
+// trực tiếp vào vị trí cuối cùng. Nội dung ban đầu toàn byte 0.
+// Trên hệ không có mmap, dùng buffer trong RAM và ghi ra file khi close().
+class MappedOutputFile {
+private:
+    std::string path;
+    unsigned char* base;
+    size_t length;
+    int fd;
+    std::vector<unsigned char> fallback;
+
+public:
+    MappedOutputFile() : base(nullptr), length(0), fd(-1) {}
+    ~MappedOutputFile() { close(); }
+    MappedOutputFile(const MappedOutputFile&) = delete;
+    MappedOutputFile& operator=(const MappedOutputFile&) = delete;
+
+    bool create(const std::string& filePath, size_t size);
+    unsigned char* data() { return base; }
+    size_t size() const { return length; }
+    bool close();
+};
+
+#endif //HUFFMANENCRYPT_HUFFMANIO_H
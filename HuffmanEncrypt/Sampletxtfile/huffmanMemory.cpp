@@ -0,0 +1,60 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanMemory.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+size_t peakMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;          // macOS: byte
+#else
+    return (size_t)usage.ru_maxrss * 1024;   // Linux: KB
+#endif
+#endif
+}
+
+bool parseMemorySize(const string& text, size_t& bytes) {
+    if (text.empty()) return false;
+    size_t value = 0, i = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++) value = value * 10 + (text[i] - '0');
+    if (i == 0) return false;
+
+    size_t unit = 1;
+    if (i < text.size()) {
+        switch (text[i]) {
+            case 'k': case 'K': unit = 1ULL << 10; break;
+            case 'm': case 'M': unit = 1ULL << 20; break;
+            case 'g': case 'G': unit = 1ULL << 30; break;
+            default: return false;
+        }
+        i++;
+        if (i < text.size() && (text[i] == 'b' || text[i] == 'B')) i++;
+    }
+    if (i != text.size()) return false;
+    bytes = value * unit;
+    return true;
+}
+
+string formatMemorySize(size_t bytes) {
+    char buf[32];
+    if (bytes < (1 << 20)) snprintf(buf, sizeof(buf), "%.1f KB", bytes / 1024.0);
+    else snprintf(buf, sizeof(buf), "%.1f MB", bytes / (1024.0 * 1024.0));
+    return buf;
+}
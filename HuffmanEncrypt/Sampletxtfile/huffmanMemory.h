@@ -0,0 +1,19 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANMEMORY_H
+#define HUFFMANENCRYPT_HUFFMANMEMORY_H
+
+#include <cstddef>
+#include <string>
+
+// Bộ nhớ đỉnh (peak RSS) của tiến trình tính đến thời điểm gọi, 0 nếu hệ điều hành không hỗ trợ
+size_t peakMemoryBytes();
+
+// Đọc kích thước dạng "512K", "64M", "2G" (không hậu tố = byte). Trả về false nếu sai cú pháp.
+bool parseMemorySize(const std::string& text, size_t& bytes);
+
+std::string formatMemorySize(size_t bytes);
+
+#endif //HUFFMANENCRYPT_HUFFMANMEMORY_H
@@ -0,0 +1,242 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanBlockCompressor.h"
+#include "huffmanChecksum.h"
+#include <iomanip>
+#include <algorithm>
+
+#ifdef HUFFMAN_WITH_MPI
+// Chỉ dùng API C của MPI: bỏ binding C++ cũ (đã bị loại khỏi chuẩn MPI-3)
+#define OMPI_SKIP_MPICXX 1
+#define MPICH_SKIP_MPICXX 1
+#include <mpi.h>
+#include <cstring>
+#endif
+
+using namespace std;
+
+#ifdef HUFFMAN_WITH_MPI
+// Mỗi lệnh đọc / ghi MPI-IO nhận số byte kiểu int: chia thành các đoạn tối đa 1 GB
+static const size_t MPI_IO_PIECE = 1u << 30;
+
+// Bảng mã cần tần suất 32 bit: dữ liệu > 4 GB thì chia đều (dịch phải), ký tự có mặt vẫn giữ tần suất >= 1
+static void scaleFrequency(const uint64_t global[256], uint32_t freq[256]) {
+    uint64_t maxFreq = *max_element(global, global + 256);
+    int shift = 0;
+    while ((maxFreq >> shift) > UINT32_MAX) shift++;
+    for (int s = 0; s < 256; s++) {
+        freq[s] = (uint32_t)(global[s] >> shift);
+        if (global[s] > 0 && freq[s] == 0) freq[s] = 1;
+    }
+}
+
+// Đọc [offset, offset + n) của file (lệnh độc lập, mỗi rank đọc dải của mình)
+static bool mpiReadRange(MPI_File fh, uint64_t offset, unsigned char* dst, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        int piece = (int)min(n - done, MPI_IO_PIECE);
+        MPI_Status status;
+        if (MPI_File_read_at(fh, (MPI_Offset)(offset + done), dst + done, piece, MPI_BYTE, &status) != MPI_SUCCESS) {
+            return false;
+        }
+        int got = 0;
+        MPI_Get_count(&status, MPI_BYTE, &got);
+        if (got <= 0) return false;
+        done += (size_t)got;
+    }
+    return true;
+}
+
+// Mọi rank phải gọi MPI_File_write_at_all cùng số lần: số lần = số đoạn của rank có nhiều dữ liệu nhất,
+// rank đã ghi xong thì ghi 0 byte
+static bool mpiWriteAll(MPI_File fh, uint64_t offset, const unsigned char* src, size_t n) {
+    uint64_t pieces = (n + MPI_IO_PIECE - 1) / MPI_IO_PIECE, maxPieces = 0;
+    MPI_Allreduce(&pieces, &maxPieces, 1, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+
+    bool ok = true;
+    size_t done = 0;
+    for (uint64_t i = 0; i < maxPieces; i++) {
+        int piece = (int)min(n - done, MPI_IO_PIECE);
+        MPI_Status status;
+        if (MPI_File_write_at_all(fh, (MPI_Offset)(offset + done), src + done, piece, MPI_BYTE, &status) != MPI_SUCCESS) {
+            ok = false;
+        }
+        done += (size_t)piece;
+    }
+    return ok;
+}
+
+// Kết quả chung của 1 bước: false nếu có rank bất kỳ thất bại (để mọi rank cùng dừng, không treo ở collective sau)
+static bool allRanksOk(bool ok) {
+    int local = ok ? 1 : 0, global = 0;
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    return global == 1;
+}
+#endif
+
+bool HuffmanBlockCompressor::compressMpi(const string& inputFilePath, const string& outputFilePath) {
+#ifdef HUFFMAN_WITH_MPI
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    int provided;
+    // Chỉ luồng chính gọi MPI, các luồng OpenMP trong rank chỉ đếm / mã hóa
+    if (!initialized) MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &provided);
+
+    int rank = 0, ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    // Mặc định 1 luồng / rank (các rank thường đã chia hết số lõi); --threads để dùng thêm OpenMP trong rank
+    numThreads = threadOverride > 0 ? threadOverride : 1;
+
+    auto finish = [&](bool ok) {
+        if (!initialized) MPI_Finalize();
+        return ok;
+    };
+
+    // --- BƯỚC 1: MỖI RANK ĐỌC DẢI BLOCK CỦA MÌNH ---
+    double start = MPI_Wtime();
+    MPI_File in;
+    if (MPI_File_open(MPI_COMM_WORLD, inputFilePath.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &in) != MPI_SUCCESS) {
+        if (rank == 0) cerr << "Loi: Khong the mo file input!" << endl;
+        return finish(false);
+    }
+    MPI_Offset fileSize = 0;
+    MPI_File_get_size(in, &fileSize);
+    uint64_t total = (uint64_t)fileSize;
+
+    // Dải block liền nhau: block không bị cắt giữa 2 rank nên file ghép lại giống hệt file của 1 tiến trình
+    uint64_t numBlocks = (total + blockSize - 1) / blockSize;
+    uint64_t firstBlock = numBlocks * rank / ranks;
+    uint64_t lastBlock = numBlocks * (rank + 1) / ranks;
+    uint64_t begin = min<uint64_t>(firstBlock * blockSize, total);
+    uint64_t end = min<uint64_t>(lastBlock * blockSize, total);
+    size_t localBytes = (size_t)(end - begin);
+
+    vector<unsigned char> local(localBytes);
+    bool ok = mpiReadRange(in, begin, local.data(), localBytes);
+    MPI_File_close(&in);
+    if (!allRanksOk(ok)) {
+        if (rank == 0) cerr << "Loi: Khong doc duoc file input!" << endl;
+        return finish(false);
+    }
+    double readTime = MPI_Wtime() - start;
+
+    // --- BƯỚC 2: HISTOGRAM CỤC BỘ + CRC32C TỪNG BLOCK, CỘNG HISTOGRAM BẰNG ALLREDUCE ---
+    start = MPI_Wtime();
+    size_t localBlocks = (size_t)(lastBlock - firstBlock);
+    vector<uint32_t> checksum(localBlocks);
+    uint64_t localFreq[256] = {0}, globalFreq[256];
+    #pragma omp parallel num_threads(numThreads) if(numThreads > 1)
+    {
+        uint64_t threadFreq[256] = {0};
+        #pragma omp for schedule(dynamic)
+        for (long long b = 0; b < (long long)localBlocks; b++) {
+            size_t offset = b * blockSize;
+            uint32_t freq[256] = {0};
+            uint32_t crc = 0;
+            histogramCrc32c(local.data() + offset, min(blockSize, localBytes - offset), freq, crc);
+            checksum[b] = crc;
+            for (int s = 0; s < 256; s++) threadFreq[s] += freq[s];
+        }
+        #pragma omp critical
+        for (int s = 0; s < 256; s++) localFreq[s] += threadFreq[s];
+    }
+    MPI_Allreduce(localFreq, globalFreq, 256, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+    uint32_t freq[256];
+    scaleFrequency(globalFreq, freq);
+    HuffmanTable table;
+    buildCodeLengths(freq, table.codeLen);
+    buildCanonicalCodes(table);
+    double histTime = MPI_Wtime() - start;
+
+    // --- BƯỚC 3: MÃ HÓA DẢI CỦA MÌNH BẰNG BẢNG MÃ CHUNG ---
+    start = MPI_Wtime();
+    vector<vector<unsigned char>> encoded(localBlocks);
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+    for (long long b = 0; b < (long long)localBlocks; b++) {
+        size_t offset = b * blockSize;
+        encodeSharedTableRecord(local.data() + offset, min(blockSize, localBytes - offset), table, checksum[b],
+                                encoded[b]);
+    }
+
+    // CRC32C của dải, rồi của toàn bộ dữ liệu (ghép CRC các rank theo thứ tự)
+    uint64_t rangeCrc[2] = {0, localBytes};
+    uint32_t crc = 0;
+    for (size_t b = 0; b < localBlocks; b++) {
+        crc = crc32cCombine(crc, checksum[b], min(blockSize, localBytes - b * blockSize));
+    }
+    rangeCrc[0] = crc;
+    vector<uint64_t> allCrc(2 * ranks);
+    MPI_Allgather(rangeCrc, 2, MPI_UINT64_T, allCrc.data(), 2, MPI_UINT64_T, MPI_COMM_WORLD);
+    uint32_t streamChecksum = 0;
+    for (int r = 0; r < ranks; r++) {
+        streamChecksum = crc32cCombine(streamChecksum, (uint32_t)allCrc[2 * r], allCrc[2 * r + 1]);
+    }
+
+    // Buffer ghi của rank: rank 0 thêm header file, rank cuối thêm bản ghi kết thúc
+    size_t outBytes = (rank == 0 ? HUFB_HEADER_SIZE : 0) + (rank == ranks - 1 ? HUFB_BLOCK_HEADER_SIZE : 0);
+    for (const auto& record : encoded) outBytes += record.size();
+    vector<unsigned char> out(outBytes);
+    size_t pos = 0;
+    if (rank == 0) {
+        writeFileHeader(out.data(), blockSize, total);
+        pos += HUFB_HEADER_SIZE;
+    }
+    for (auto& record : encoded) {
+        memcpy(out.data() + pos, record.data(), record.size());
+        pos += record.size();
+        vector<unsigned char>().swap(record);
+    }
+    if (rank == ranks - 1) writeEndRecord(out.data() + pos, streamChecksum);
+    double encodeTime = MPI_Wtime() - start;
+
+    // --- BƯỚC 4: VỊ TRÍ GHI = EXCLUSIVE SCAN KÍCH THƯỚC, GHI COLLECTIVE VÀO 1 FILE ---
+    start = MPI_Wtime();
+    uint64_t size64 = outBytes, offset = 0, compressedSize = 0;
+    MPI_Exscan(&size64, &offset, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0) offset = 0; // Kết quả Exscan ở rank 0 không xác định
+    MPI_Allreduce(&size64, &compressedSize, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+    MPI_File outFile;
+    if (MPI_File_open(MPI_COMM_WORLD, outputFilePath.c_str(), MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL,
+                      &outFile) != MPI_SUCCESS) {
+        if (rank == 0) cerr << "Loi: Khong the tao file output!" << endl;
+        return finish(false);
+    }
+    MPI_File_set_size(outFile, (MPI_Offset)compressedSize); // Cắt phần thừa nếu file cũ dài hơn
+    ok = mpiWriteAll(outFile, offset, out.data(), outBytes);
+    MPI_File_close(&outFile);
+    ok = allRanksOk(ok);
+    double writeTime = MPI_Wtime() - start;
+
+    // Thời gian mỗi bước là của rank chậm nhất
+    double times[4] = {readTime, histTime, encodeTime, writeTime}, maxTimes[4];
+    MPI_Reduce(times, maxTimes, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        if (!ok) cerr << "Loi: Khong the ghi file output!" << endl;
+        cout << "--- BAT DAU QUA TRINH NEN HUFFMAN (MPI, " << ranks << " rank x " << numThreads << " luong) ---" << endl;
+        cout << "Input:  " << inputFilePath << endl;
+        cout << "Output: " << outputFilePath << endl;
+        cout << "So block: " << numBlocks << " (" << blockSize << " bytes / block), bang ma chung cho moi block" << endl;
+        cout << "[1] Doc dai block cua moi rank: " << (long long)(maxTimes[0] * 1e6) << " us" << endl;
+        cout << "[2] Histogram + MPI_Allreduce + bang ma: " << (long long)(maxTimes[1] * 1e6) << " us" << endl;
+        cout << "[3] Ma hoa: " << (long long)(maxTimes[2] * 1e6) << " us" << endl;
+        cout << "[4] Exscan + ghi collective: " << (long long)(maxTimes[3] * 1e6) << " us" << endl;
+        cout << "\n--- KET QUA ---" << endl;
+        cout << "Kich thuoc goc:     " << total << " bytes" << endl;
+        cout << "Kich thuoc sau nen: " << compressedSize << " bytes" << endl;
+        double ratio = total > 0 ? (1.0 - (double)compressedSize / total) * 100 : 0;
+        cout << "Ty le nen: " << fixed << setprecision(2) << ratio << "%" << endl;
+        cout << "----------------------------------------------" << endl;
+    }
+    return finish(ok);
+#else
+    (void)inputFilePath;
+    (void)outputFilePath;
+    cerr << "Loi: Ban build nay khong co MPI (can build lai voi thu vien MPI)" << endl;
+    return false;
+#endif
+}
@@ -0,0 +1,224 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanNuma.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <new>
+#include <omp.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+using namespace std;
+
+#ifdef __linux__
+// Affinity mask của tiến trình lúc đọc topology (taskset / cgroup cpuset), dùng để bỏ ghim
+static cpu_set_t initialMask;
+static bool haveInitialMask = false;
+// CPU luồng hiện tại đang bị ghim (-1 = chưa ghim). Luồng OpenMP được dùng lại giữa các vùng song song
+// nên phần lớn lần gọi pinCurrentThread không cần syscall.
+static thread_local int pinnedCpu = -1;
+
+// Đọc danh sách CPU dạng "0-3,8-11"
+static vector<int> parseCpuList(const string& text) {
+    vector<int> cpus;
+    size_t i = 0;
+    while (i < text.size()) {
+        char* endPtr;
+        long first = strtol(text.c_str() + i, &endPtr, 10);
+        if (endPtr == text.c_str() + i) break;
+        long last = first;
+        i = endPtr - text.c_str();
+        if (i < text.size() && text[i] == '-') {
+            last = strtol(text.c_str() + i + 1, &endPtr, 10);
+            i = endPtr - text.c_str();
+        }
+        for (long c = first; c <= last; c++) cpus.push_back((int)c);
+        if (i < text.size() && text[i] == ',') i++;
+        else break;
+    }
+    return cpus;
+}
+#endif
+
+const NumaTopology& NumaTopology::instance() {
+    static const NumaTopology topology = [] {
+        NumaTopology t;
+#ifdef __linux__
+        CPU_ZERO(&initialMask);
+        haveInitialMask = sched_getaffinity(0, sizeof(initialMask), &initialMask) == 0;
+
+        // Tên thư mục node<N>, sắp theo N
+        vector<int> nodeIds;
+        if (DIR* dir = opendir("/sys/devices/system/node")) {
+            while (dirent* entry = readdir(dir)) {
+                if (strncmp(entry->d_name, "node", 4) != 0) continue;
+                char* endPtr;
+                long id = strtol(entry->d_name + 4, &endPtr, 10);
+                if (endPtr != entry->d_name + 4 && *endPtr == '\0') nodeIds.push_back((int)id);
+            }
+            closedir(dir);
+        }
+        sort(nodeIds.begin(), nodeIds.end());
+
+        for (int id : nodeIds) {
+            ifstream in("/sys/devices/system/node/node" + to_string(id) + "/cpulist");
+            string line;
+            if (!in || !getline(in, line)) continue;
+            vector<int> cpus;
+            for (int cpu : parseCpuList(line)) {
+                if (cpu >= CPU_SETSIZE) continue;
+                if (!haveInitialMask || CPU_ISSET(cpu, &initialMask)) cpus.push_back(cpu);
+            }
+            if (!cpus.empty()) t.nodeCpus.push_back(cpus);
+        }
+
+        // Không có sysfs (container hạn chế): 1 node gồm các CPU được phép
+        if (t.nodeCpus.empty() && haveInitialMask) {
+            vector<int> cpus;
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &initialMask)) cpus.push_back(cpu);
+            }
+            if (!cpus.empty()) t.nodeCpus.push_back(cpus);
+        }
+#endif
+        if (t.nodeCpus.empty()) t.nodeCpus.push_back({});
+        return t;
+    }();
+    return topology;
+}
+
+int numaNodeForThread(int index, int numThreads) {
+    int nodes = NumaTopology::instance().nodes();
+    if (numThreads <= 0) return 0;
+    return (int)((long long)index * nodes / numThreads);
+}
+
+bool pinCurrentThread(int index, int numThreads) {
+#ifdef __linux__
+    const NumaTopology& topology = NumaTopology::instance();
+    int node = numaNodeForThread(index, numThreads);
+    const vector<int>& cpus = topology.nodeCpus[node];
+    if (cpus.empty()) return false;
+
+    // Vị trí của luồng trong nhóm luồng cùng node
+    int nodes = topology.nodes();
+    int firstThread = (int)(((long long)node * numThreads + nodes - 1) / nodes);
+    int cpu = cpus[(index - firstThread) % cpus.size()];
+
+    if (pinnedCpu == cpu) return true;
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0) return false;
+    pinnedCpu = cpu;
+    return true;
+#else
+    (void)index;
+    (void)numThreads;
+    return false;
+#endif
+}
+
+void unpinCurrentThread() {
+#ifdef __linux__
+    NumaTopology::instance();
+    if (haveInitialMask) sched_setaffinity(0, sizeof(initialMask), &initialMask);
+    pinnedCpu = -1;
+#endif
+}
+
+void NumaBuffer::release() {
+#ifdef __linux__
+    if (ptr) munmap(ptr, cap);
+#else
+    delete[] ptr;
+#endif
+    ptr = nullptr;
+    length = cap = 0;
+}
+
+bool NumaBuffer::resize(size_t n) {
+    if (n <= cap) {
+        length = n;
+        return true;
+    }
+    release();
+#ifdef __linux__
+    void* p = mmap(nullptr, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return false;
+    ptr = static_cast<char*>(p);
+#else
+    ptr = new (nothrow) char[n]; // Không khởi tạo: trang nhớ chưa bị chạm
+    if (!ptr) return false;
+#endif
+    length = cap = n;
+    return true;
+}
+
+bool readFileFirstTouch(const string& path, NumaBuffer& buf, int numThreads) {
+#ifdef __linux__
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !buf.resize((size_t)st.st_size)) {
+        close(fd);
+        return false;
+    }
+    size_t fileSize = buf.size();
+    atomic<bool> failed(false);
+
+    #pragma omp parallel num_threads(numThreads) if(numThreads > 1)
+    {
+        int thread = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        pinCurrentThread(thread, threads);
+
+        size_t begin, end;
+        numaSlice(thread, threads, fileSize, begin, end);
+        while (begin < end) {
+            ssize_t n = pread(fd, buf.data() + begin, end - begin, (off_t)begin);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                failed = true;
+                break;
+            }
+            begin += (size_t)n;
+        }
+    }
+    close(fd);
+    return !failed;
+#else
+    (void)numThreads;
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    in.seekg(0, ios::end);
+    long long fileSize = (long long)in.tellg();
+    in.seekg(0, ios::beg);
+    if (fileSize < 0 || !buf.resize((size_t)fileSize)) return false;
+    in.read(buf.data(), fileSize);
+    return (bool)in || fileSize == 0;
+#endif
+}
+
+string numaDescribe() {
+    const NumaTopology& topology = NumaTopology::instance();
+    string text = to_string(topology.nodes()) + " node:";
+    for (int i = 0; i < topology.nodes(); i++) {
+        text += (i ? ", node " : " node ") + to_string(i) + " = " + to_string(topology.nodeCpus[i].size()) + " CPU";
+    }
+    return text;
+}
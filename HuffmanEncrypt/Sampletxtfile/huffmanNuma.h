@@ -0,0 +1,71 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANNUMA_H
+#define HUFFMANENCRYPT_HUFFMANNUMA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Hỗ trợ NUMA không cần libnuma: đọc topology từ /sys/devices/system/node, ghim luồng bằng
+// sched_setaffinity và dựa vào chính sách first-touch mặc định của kernel (trang nhớ nằm trên node
+// của luồng ghi nó đầu tiên). Trên hệ khác Linux chỉ có 1 node và việc ghim luồng không làm gì.
+
+// Các CPU (trong affinity mask ban đầu của tiến trình) của từng node; node không có CPU được phép bị bỏ qua
+struct NumaTopology {
+    std::vector<std::vector<int>> nodeCpus;
+
+    int nodes() const { return (int)nodeCpus.size(); }
+    // Đọc 1 lần, trước khi có luồng nào bị ghim
+    static const NumaTopology& instance();
+};
+
+// Luồng thứ index trong nhóm numThreads: các luồng liên tiếp được chia đều, theo khối, cho các node
+// (luồng 0..p/2-1 ở node 0, ... với 2 node) để mỗi node giữ 1 đoạn input liền nhau.
+int numaNodeForThread(int index, int numThreads);
+// Ghim luồng gọi hàm vào 1 CPU của node tương ứng. Trả về false nếu hệ điều hành không hỗ trợ.
+bool pinCurrentThread(int index, int numThreads);
+// Trả luồng gọi hàm về affinity mask ban đầu của tiến trình
+void unpinCurrentThread();
+
+// Đoạn [begin, end) của phần thứ index khi chia n byte cho count phần
+inline void numaSlice(int index, int count, size_t n, size_t& begin, size_t& end) {
+    begin = n * index / count;
+    end = n * (index + 1) / count;
+}
+
+// Buffer cấp phát nhưng chưa chạm vào (mmap ẩn danh): trang nhớ chỉ được cấp khi ghi lần đầu,
+// trên node của luồng ghi. Khác std::string::resize (luồng chính ghi 0 vào toàn bộ buffer).
+class NumaBuffer {
+private:
+    char* ptr;
+    size_t length;
+    size_t cap;
+
+    void release();
+
+public:
+    NumaBuffer() : ptr(nullptr), length(0), cap(0) {}
+    ~NumaBuffer() { release(); }
+    NumaBuffer(const NumaBuffer&) = delete;
+    NumaBuffer& operator=(const NumaBuffer&) = delete;
+
+    // Nội dung cũ không được giữ khi phải cấp phát lại. Vùng nhớ đủ lớn được dùng lại và trang nhớ giữ node
+    // của lần ghi đầu, nên context NUMA nên được dùng lại với cùng số luồng.
+    bool resize(size_t n);
+    char* data() { return ptr; }
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+    size_t capacity() const { return cap; }
+};
+
+// Đọc file vào buf bằng numThreads luồng: luồng i (đã ghim) đọc đoạn numaSlice(i) bằng pread nên
+// các trang của đoạn đó nằm trên node của luồng. Hệ không có pread: đọc tuần tự.
+bool readFileFirstTouch(const std::string& path, NumaBuffer& buf, int numThreads);
+
+// Mô tả topology để in ra (vd "2 node: node 0 = 16 CPU, node 1 = 16 CPU")
+std::string numaDescribe();
+
+#endif //HUFFMANENCRYPT_HUFFMANNUMA_H
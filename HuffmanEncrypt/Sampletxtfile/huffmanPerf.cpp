@@ -0,0 +1,136 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanPerf.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace std;
+
+static const char* EVENT_NAMES[PERF_EVENT_COUNT] = {"cycles", "instructions", "branch-misses", "LLC-misses"};
+
+#ifdef __linux__
+static int openEvent(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.inherit = 1;        // Đếm cả các luồng tạo sau (nhóm luồng OpenMP, worker pipeline)
+    attr.exclude_kernel = 1; // perf_event_paranoid = 2 (mặc định) chỉ cho đếm ở user space
+    attr.exclude_hv = 1;
+    // Cờ inherit không đi cùng PERF_FORMAT_GROUP được: mỗi bộ đếm là 1 fd riêng
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) fd[e] = -1;
+#ifdef __linux__
+    fd[PERF_CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    int openErrno = fd[PERF_CYCLES] < 0 ? errno : 0;
+    fd[PERF_INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fd[PERF_BRANCH_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fd[PERF_LLC_MISSES] = openEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    // Một số CPU / máy ảo không có sự kiện LLC riêng: dùng sự kiện cache miss chung (thường cũng là LLC)
+    if (fd[PERF_LLC_MISSES] < 0) fd[PERF_LLC_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+    if (available()) {
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            if (fd[e] < 0) continue;
+            if (!state.empty()) state += ", ";
+            state += EVENT_NAMES[e];
+        }
+    } else {
+        if (openErrno == 0) openErrno = errno;
+        state = string("khong dung duoc (perf_event_open: ") + strerror(openErrno);
+        ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+        int level;
+        if (paranoid >> level) state += ", perf_event_paranoid = " + to_string(level);
+        state += ")";
+    }
+#else
+    state = "khong dung duoc (chi ho tro tren Linux)";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (fd[e] >= 0) close(fd[e]);
+    }
+#endif
+}
+
+PerfCounters& PerfCounters::instance() {
+    static PerfCounters counters;
+    return counters;
+}
+
+bool PerfCounters::available() const {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (fd[e] >= 0) return true;
+    }
+    return false;
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample sample;
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (fd[e] < 0) continue;
+        uint64_t data[3]; // value, time_enabled, time_running
+        if (::read(fd[e], data, sizeof(data)) != (ssize_t)sizeof(data)) continue;
+        // Bộ đếm chỉ chạy 1 phần thời gian khi có nhiều sự kiện hơn thanh ghi PMU: ngoại suy theo tỉ lệ
+        if (data[2] == 0) continue;
+        sample.value[e] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+        sample.valid[e] = true;
+    }
+#endif
+    return sample;
+}
+
+PerfStage::PerfStage() : begin(PerfCounters::instance().read()), start(chrono::steady_clock::now()) {}
+
+void PerfStage::stop() {
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    PerfSample end = PerfCounters::instance().read();
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        counters.valid[e] = begin.valid[e] && end.valid[e];
+        counters.value[e] = counters.valid[e] && end.value[e] > begin.value[e] ? end.value[e] - begin.value[e] : 0;
+    }
+}
+
+string perfColumnsHeader() {
+    ostringstream out;
+    out << setw(10) << "cyc/B" << setw(8) << "IPC" << setw(14) << "br-miss/KB" << setw(14) << "LLC-miss/KB";
+    return out.str();
+}
+
+string perfColumns(const PerfSample& sample, uint64_t bytes) {
+    ostringstream out;
+    out << fixed;
+    double kb = bytes / 1024.0;
+    auto column = [&](bool valid, int width, int precision, double value) {
+        if (valid) out << setw(width) << setprecision(precision) << value;
+        else out << setw(width) << "-";
+    };
+    column(sample.valid[PERF_CYCLES] && bytes > 0, 10, 2, (double)sample.value[PERF_CYCLES] / bytes);
+    column(sample.valid[PERF_CYCLES] && sample.valid[PERF_INSTRUCTIONS] && sample.value[PERF_CYCLES] > 0, 8, 2,
+           (double)sample.value[PERF_INSTRUCTIONS] / sample.value[PERF_CYCLES]);
+    column(sample.valid[PERF_BRANCH_MISSES] && bytes > 0, 14, 2, sample.value[PERF_BRANCH_MISSES] / kb);
+    column(sample.valid[PERF_LLC_MISSES] && bytes > 0, 14, 3, sample.value[PERF_LLC_MISSES] / kb);
+    return out.str();
+}
@@ -0,0 +1,69 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANPERF_H
+#define HUFFMANENCRYPT_HUFFMANPERF_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Bộ đếm phần cứng qua perf_event_open (Linux): cho biết 1 công đoạn bị giới hạn bởi rẽ nhánh đoán sai
+// hay trượt cache, điều mà thời gian đơn thuần không nói được. Bộ đếm đếm mọi luồng của tiến trình
+// (cờ inherit) nên phải mở trước khi OpenMP tạo nhóm luồng. Không được phép (perf_event_paranoid,
+// seccomp trong container) hoặc không phải Linux thì mọi bộ đếm không hợp lệ và chỉ còn đo thời gian.
+
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_LLC_MISSES,
+    PERF_EVENT_COUNT,
+};
+
+struct PerfSample {
+    uint64_t value[PERF_EVENT_COUNT] = {};
+    bool valid[PERF_EVENT_COUNT] = {};
+};
+
+class PerfCounters {
+private:
+    int fd[PERF_EVENT_COUNT];
+    std::string state; // Mô tả để in ra: các bộ đếm mở được, hoặc lý do không dùng được
+
+    PerfCounters();
+
+public:
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Mở ở lần gọi đầu tiên
+    static PerfCounters& instance();
+    bool available() const;
+    // Giá trị cộng dồn hiện tại (đã hiệu chỉnh khi kernel phải luân phiên bộ đếm)
+    PerfSample read() const;
+    const std::string& status() const { return state; }
+};
+
+// Đo 1 công đoạn: thời gian và chênh lệch bộ đếm giữa lúc tạo và lúc stop()
+class PerfStage {
+private:
+    PerfSample begin;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    double seconds = 0;
+    PerfSample counters;
+
+    PerfStage();
+    void stop();
+};
+
+// Dòng tiêu đề và các cột chỉ số theo số byte đã xử lý: cycles/byte, IPC, branch miss và LLC miss trên KB.
+// Bộ đếm không hợp lệ in "-".
+std::string perfColumnsHeader();
+std::string perfColumns(const PerfSample& sample, uint64_t bytes);
+
+#endif //HUFFMANENCRYPT_HUFFMANPERF_H
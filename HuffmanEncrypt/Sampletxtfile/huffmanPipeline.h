@@ -0,0 +1,80 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANPIPELINE_H
+#define HUFFMANENCRYPT_HUFFMANPIPELINE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "huffmanBlock.h"
+
+// Hàng đợi có giới hạn giữa các công đoạn của pipeline (đọc -> mã hóa -> ghi).
+// push() chờ khi đầy, pop() chờ khi rỗng; sau close() thì pop() trả về false khi hết phần tử.
+// tryPush() không chờ (cho luồng không được phép bị chặn, như event loop).
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    std::mutex mtx;
+    std::condition_variable notEmpty, notFull;
+
+public:
+    explicit BoundedQueue(size_t cap) : capacity(cap) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        notFull.wait(lock, [&] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    enum class TryPush { Ok, Full, Closed };
+
+    TryPush tryPush(T item) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed) return TryPush::Closed;
+        if (items.size() >= capacity) return TryPush::Full;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return TryPush::Ok;
+    }
+
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
+
+// Một block đang đi qua pipeline. Các job được cấp phát sẵn thành 1 pool cố định
+// và tái sử dụng, nên bộ nhớ của pipeline bị chặn bởi kích thước pool.
+struct PipelineJob {
+    size_t index = 0;
+    size_t rawSize = 0;
+    BlockType type = BLOCK_HUFFMAN;
+    uint32_t checksum = 0;  // CRC32C của dữ liệu gốc của block
+    bool ok = true;
+    std::vector<unsigned char> input;
+    std::vector<unsigned char> output;
+};
+
+#endif //HUFFMANENCRYPT_HUFFMANPIPELINE_H
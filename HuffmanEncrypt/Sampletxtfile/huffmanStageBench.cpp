@@ -0,0 +1,150 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanBlockCompressor.h"
+#include "huffmanChecksum.h"
+#include "huffmanPerf.h"
+#include <cstring>
+#include <iomanip>
+
+using namespace std;
+
+enum BenchStage {
+    STAGE_HISTOGRAM,
+    STAGE_BUILD,
+    STAGE_ENCODE,
+    STAGE_PACK,
+    STAGE_WRITE,
+    STAGE_DECODE,
+    STAGE_COUNT,
+};
+
+static const char* STAGE_NAMES[STAGE_COUNT] = {
+    "Histogram + CRC", "Dung bang ma", "Ma hoa", "Ghep ban ghi", "Ghi file", "Giai ma",
+};
+
+static const int BENCH_RUNS = 3; // Lấy lần nhanh nhất (lần đầu còn chịu page fault khi cấp phát buffer)
+
+struct StageResult {
+    double seconds = -1;
+    PerfSample counters;
+};
+
+bool HuffmanBlockCompressor::benchmarkStages(const string& inputFilePath, const string& outputFilePath) {
+    // Mở bộ đếm trước vùng song song đầu tiên để các luồng OpenMP được đếm (cờ inherit)
+    PerfCounters& perf = PerfCounters::instance();
+
+    string content;
+    if (!readWholeFile(inputFilePath, content)) {
+        cerr << "Loi: Khong the mo file input!" << endl;
+        return false;
+    }
+    size_t total = content.size();
+    size_t numBlocks = (total + blockSize - 1) / blockSize;
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(content.data());
+    numThreads = chooseThreads(total);
+
+    cout << "--- DO TUNG CONG DOAN (BLOCK) ---" << endl;
+    cout << "Input: " << inputFilePath << " (" << total << " bytes, " << numBlocks << " block, "
+         << numThreads << " luong)" << endl;
+    cout << "Kernel giai ma: " << decodeKernelName(resolveDecodeKernel(kernel)) << endl;
+    cout << "Bo dem phan cung: " << perf.status() << endl;
+
+    vector<BlockHistogram> hist(numBlocks);
+    vector<BlockPlan> plans(numBlocks);
+    vector<vector<unsigned char>> payloads(numBlocks);
+    vector<size_t> recordOffset(numBlocks + 1);
+    vector<unsigned char> packed;
+    vector<unsigned char> decoded(total);
+    StageResult best[STAGE_COUNT];
+    bool ok = true;
+
+    for (int run = 0; run < BENCH_RUNS && ok; run++) {
+        auto measure = [&](BenchStage stage, auto&& body) {
+            PerfStage measured;
+            body();
+            measured.stop();
+            if (best[stage].seconds < 0 || measured.seconds < best[stage].seconds) {
+                best[stage].seconds = measured.seconds;
+                best[stage].counters = measured.counters;
+            }
+        };
+
+        measure(STAGE_HISTOGRAM, [&] {
+            #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+            for (long long b = 0; b < (long long)numBlocks; b++) {
+                size_t offset = b * blockSize;
+                countBlockHistogram(src + offset, min(blockSize, total - offset), hist[b], symbolMode);
+            }
+        });
+
+        measure(STAGE_BUILD, [&] {
+            #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+            for (long long b = 0; b < (long long)numBlocks; b++) planBlock(hist[b], plans[b]);
+        });
+
+        measure(STAGE_ENCODE, [&] {
+            #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+            for (long long b = 0; b < (long long)numBlocks; b++) {
+                size_t offset = b * blockSize;
+                payloads[b].resize(plans[b].payloadSize);
+                encodeBlock(src + offset, hist[b], plans[b], payloads[b].data());
+            }
+        });
+
+        // Header file + header từng block + payload vào 1 buffer liền, bản ghi kết thúc mang CRC ghép từ các block
+        measure(STAGE_PACK, [&] {
+            recordOffset[0] = HUFB_HEADER_SIZE;
+            uint32_t streamChecksum = 0;
+            for (size_t b = 0; b < numBlocks; b++) {
+                recordOffset[b + 1] = recordOffset[b] + HUFB_BLOCK_HEADER_SIZE + payloads[b].size();
+                streamChecksum = crc32cCombine(streamChecksum, hist[b].checksum, hist[b].n);
+            }
+            packed.resize(recordOffset[numBlocks] + HUFB_BLOCK_HEADER_SIZE);
+            writeFileHeader(packed.data(), blockSize, total);
+
+            #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+            for (long long b = 0; b < (long long)numBlocks; b++) {
+                unsigned char* record = packed.data() + recordOffset[b];
+                writeBlockHeader(record, plans[b].type, hist[b].n, payloads[b].size(), hist[b].checksum);
+                memcpy(record + HUFB_BLOCK_HEADER_SIZE, payloads[b].data(), payloads[b].size());
+            }
+            writeEndRecord(packed.data() + recordOffset[numBlocks], streamChecksum);
+        });
+
+        measure(STAGE_WRITE, [&] {
+            ok = ok && writeWholeFile(outputFilePath, {{packed.data(), packed.size()}});
+        });
+
+        measure(STAGE_DECODE, [&] {
+            bool decodeOk = true;
+            #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1) reduction(&&:decodeOk)
+            for (long long b = 0; b < (long long)numBlocks; b++) {
+                size_t offset = b * blockSize;
+                decodeOk = decodeBlock(plans[b].type, payloads[b].data(), payloads[b].size(),
+                                       decoded.data() + offset, hist[b].n, kernel) && decodeOk;
+            }
+            ok = ok && decodeOk;
+        });
+    }
+
+    if (!ok || (total > 0 && memcmp(decoded.data(), src, total) != 0)) {
+        cerr << "Loi: Ghi file output that bai hoac giai ma khong khop du lieu goc!" << endl;
+        return false;
+    }
+
+    // Mọi chỉ số tính theo byte dữ liệu gốc để so được giữa các công đoạn
+    cout << endl << left << setw(17) << "Cong doan" << right << setw(10) << "ms" << setw(10) << "MB/s"
+         << perfColumnsHeader() << endl;
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        cout << left << setw(17) << STAGE_NAMES[s] << right << fixed << setprecision(2)
+             << setw(10) << best[s].seconds * 1e3;
+        if (best[s].seconds > 0) cout << setw(10) << setprecision(1) << total / best[s].seconds / 1e6;
+        else cout << setw(10) << "-";
+        cout << perfColumns(best[s].counters, total) << endl;
+    }
+    cout << "Kich thuoc sau nen: " << packed.size() << " bytes (tot nhat trong " << BENCH_RUNS << " lan)" << endl;
+    cout << "----------------------------------------------" << endl;
+    return true;
+}
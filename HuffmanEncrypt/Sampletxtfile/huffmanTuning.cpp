@@ -0,0 +1,177 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#include "huffmanTuning.h"
+#include <omp.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static const char* TUNE_CACHE_TAG = "huffman-tune-v2";
+static const size_t MIN_CHUNK_BYTES = 64 * 1024;
+
+// Kernel của HuffmanCompressorPar: đếm tần suất + nối mã dạng chuỗi
+static size_t stringConcatKernel(const unsigned char* data, size_t n) {
+    string codes[256];
+    for (int s = 0; s < 256; s++) codes[s] = string(4 + s % 3, '0' + s % 2);
+    long freq[256] = {0};
+    for (size_t i = 0; i < n; i++) freq[data[i]]++;
+    string encoded;
+    encoded.reserve(n * 6);
+    for (size_t i = 0; i < n; i++) encoded += codes[data[i]];
+    return encoded.size() + freq['a'];
+}
+
+const TuneEngine TUNE_ENGINE_STRING = {"string", stringConcatKernel};
+
+static atomic<bool> diskCacheEnabled(false);
+
+ParallelTuner::ParallelTuner(const TuneEngine& tuneEngine)
+    : engine(&tuneEngine), nsPerByte(1.0), forkJoinUs(0.0), perThreadUs(0.0), maxThreads(omp_get_max_threads()) {}
+
+void ParallelTuner::enableDiskCache() {
+    diskCacheEnabled = true;
+}
+
+// Đường dẫn file cache của engine: biến môi trường HUFFMAN_TUNE_CACHE (tiền tố), nếu không có và cache đã
+// được bật thì đặt trong thư mục home; tên engine được nối vào sau
+string ParallelTuner::cachePath(const TuneEngine& engine) {
+    string base;
+    if (const char* path = getenv("HUFFMAN_TUNE_CACHE")) base = path;
+    else if (!diskCacheEnabled) return "";
+    else if (const char* home = getenv("HOME")) base = string(home) + "/.huffman_tune";
+    else if (const char* home = getenv("USERPROFILE")) base = string(home) + "\\.huffman_tune";
+    else base = ".huffman_tune";
+    return base + "-" + engine.name;
+}
+
+const ParallelTuner& ParallelTuner::instance(const TuneEngine& engine) {
+    // Mỗi engine được đo 1 lần; mô hình không bao giờ bị xóa nên tham chiếu trả về luôn hợp lệ
+    static mutex mtx;
+    static map<string, unique_ptr<ParallelTuner>> tuners;
+    lock_guard<mutex> lock(mtx);
+    unique_ptr<ParallelTuner>& tuner = tuners[engine.name];
+    if (!tuner) {
+        tuner = make_unique<ParallelTuner>(engine);
+        string path = cachePath(engine);
+        if (path.empty() || !tuner->loadCache(path)) {
+            tuner->calibrate();
+            if (!path.empty()) tuner->saveCache(path);
+        }
+    }
+    return *tuner;
+}
+
+bool ParallelTuner::loadCache(const string& path) {
+    ifstream in(path);
+    if (!in) return false;
+
+    string tag, name;
+    int threads = 0;
+    in >> tag >> name >> nsPerByte >> forkJoinUs >> perThreadUs >> threads;
+    // Cache của cấu hình khác (số luồng thay đổi, engine khác) thì đo lại
+    return in && tag == TUNE_CACHE_TAG && name == engine->name && threads == maxThreads && nsPerByte > 0;
+}
+
+void ParallelTuner::saveCache(const string& path) const {
+    ofstream out(path);
+    if (!out) return; // Không ghi được cache thì lần sau đo lại, không phải lỗi
+    out << TUNE_CACHE_TAG << " " << engine->name << "\n" << nsPerByte << " " << forkJoinUs << " " << perThreadUs << " " << maxThreads << "\n";
+}
+
+// Đo các hệ số của mô hình bằng các vòng lặp nhỏ (vài chục ms)
+void ParallelTuner::calibrate() {
+    volatile size_t sink = 0; // Giữ kết quả để các vòng lặp đo không bị trình biên dịch loại bỏ
+
+    // 1. Chi phí xử lý mỗi byte trên 1 luồng: kernel của engine trên dữ liệu mẫu
+    const size_t sampleSize = 2 * 1024 * 1024;
+    vector<unsigned char> sample(sampleSize);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sampleSize; i++) {
+        seed = seed * 1103515245u + 12345u;
+        sample[i] = (unsigned char)('a' + (seed >> 16) % 32);
+    }
+
+    auto start = high_resolution_clock::now();
+    sink = sink + engine->kernel(sample.data(), sampleSize);
+    auto end = high_resolution_clock::now();
+    nsPerByte = max(0.01, duration_cast<nanoseconds>(end - start).count() / (double)sampleSize);
+
+    if (maxThreads <= 1) return;
+
+    // 2. Chi phí fork/join của 1 vùng song song rỗng
+    const int rounds = 200;
+    start = high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        #pragma omp parallel num_threads(maxThreads)
+        {
+            if (omp_get_thread_num() == 0) sink = sink + 1;
+        }
+    }
+    end = high_resolution_clock::now();
+    forkJoinUs = duration_cast<nanoseconds>(end - start).count() / 1000.0 / rounds;
+
+    // 3. Chi phí thêm cho mỗi luồng: buffer cục bộ + gộp histogram trong vùng critical
+    long merged[256] = {0};
+    start = high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        #pragma omp parallel num_threads(maxThreads)
+        {
+            string local;
+            local.reserve(MIN_CHUNK_BYTES);
+            long localFreq[256] = {0};
+            localFreq[omp_get_thread_num() & 255] = (long)local.capacity();
+
+            #pragma omp critical
+            {
+                for (int s = 0; s < 256; s++) merged[s] += localFreq[s];
+            }
+        }
+    }
+    end = high_resolution_clock::now();
+    double regionUs = duration_cast<nanoseconds>(end - start).count() / 1000.0 / rounds;
+    perThreadUs = max(0.0, (regionUs - forkJoinUs) / maxThreads);
+    sink = sink + merged[0];
+}
+
+double ParallelTuner::predictUs(size_t bytes, int threads) const {
+    double work = bytes * nsPerByte / 1000.0;
+    if (threads <= 1) return work;
+    return work / threads + forkJoinUs + threads * perThreadUs;
+}
+
+ParallelPlan ParallelTuner::plan(size_t bytes) const {
+    int best = 1;
+    for (int p = 2; p <= maxThreads; p++) {
+        if (predictUs(bytes, p) < predictUs(bytes, best)) best = p;
+    }
+
+    ParallelPlan result;
+    result.threads = best;
+    // Chia nhiều chunk hơn số luồng để cân bằng tải, nhưng mỗi chunk không nhỏ hơn MIN_CHUNK_BYTES
+    result.chunks = best == 1 ? 1 : max((size_t)best, min((size_t)best * 4, bytes / MIN_CHUNK_BYTES));
+    return result;
+}
+
+size_t ParallelTuner::breakEvenBytes() const {
+    if (maxThreads <= 1) return SIZE_MAX;
+
+    // n * c * (1 - 1/p) > F + p * M  =>  n > (F + p * M) / (c * (1 - 1/p))
+    double best = -1;
+    for (int p = 2; p <= maxThreads; p++) {
+        double n = (forkJoinUs + p * perThreadUs) * 1000.0 / (nsPerByte * (1.0 - 1.0 / p));
+        if (best < 0 || n < best) best = n;
+    }
+    return (size_t)best + 1;
+}
@@ -0,0 +1,63 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANTUNING_H
+#define HUFFMANENCRYPT_HUFFMANTUNING_H
+
+#include <cstddef>
+#include <string>
+
+// Số luồng và số chunk được chọn cho một lần nén
+struct ParallelPlan {
+    int threads;
+    size_t chunks;
+};
+
+// Kernel tiêu biểu của 1 engine nén, dùng để đo chi phí mỗi byte: xử lý n byte trên 1 luồng đúng như
+// engine đó làm (trả về 1 giá trị bất kỳ phụ thuộc kết quả để vòng đo không bị trình biên dịch loại bỏ).
+// Các engine có chi phí mỗi byte rất khác nhau nên mỗi engine có mô hình và file cache riêng.
+struct TuneEngine {
+    const char* name; // Tên ngắn, dùng trong tên file cache
+    size_t (*kernel)(const unsigned char* data, size_t n);
+};
+
+// HuffmanCompressorPar: đếm tần suất + nối chuỗi mã '0' / '1'
+extern const TuneEngine TUNE_ENGINE_STRING;
+
+// Mô hình chi phí song song của 1 engine, đo một lần trong mỗi tiến trình; lưu vào file cache (dùng lại
+// giữa các lần chạy) chỉ khi HUFFMAN_TUNE_CACHE được đặt hoặc chương trình gọi enableDiskCache():
+//   T(n, 1) = n * nsPerByte
+//   T(n, p) = n * nsPerByte / p + forkJoinUs + p * perThreadUs     (p > 1)
+// Với file nhỏ, chi phí fork/join và cấp phát buffer cho từng luồng lớn hơn phần tiết kiệm được,
+// nên mô hình chọn p = 1 (chạy tuần tự).
+class ParallelTuner {
+private:
+    const TuneEngine* engine;
+    double nsPerByte;    // Thời gian xử lý 1 byte trên 1 luồng (kernel của engine)
+    double forkJoinUs;   // Chi phí mở và đóng 1 vùng song song
+    double perThreadUs;  // Chi phí thêm cho mỗi luồng (buffer cục bộ, gộp kết quả)
+    int maxThreads;
+
+    bool loadCache(const std::string& path);
+    void saveCache(const std::string& path) const;
+    void calibrate();
+
+public:
+    explicit ParallelTuner(const TuneEngine& tuneEngine);
+
+    // Mô hình của engine, dùng chung cho cả tiến trình (đọc cache hoặc đo lần đầu)
+    static const ParallelTuner& instance(const TuneEngine& engine);
+    // Cho phép cache trong thư mục home (CLI / daemon gọi lúc khởi động). Thư viện mặc định không ghi file.
+    static void enableDiskCache();
+    // Rỗng: không có cache trên đĩa
+    static std::string cachePath(const TuneEngine& engine);
+
+    double predictUs(size_t bytes, int threads) const;
+    ParallelPlan plan(size_t bytes) const;
+    // Kích thước nhỏ nhất mà chạy song song nhanh hơn chạy tuần tự
+    size_t breakEvenBytes() const;
+    int hardwareThreads() const { return maxThreads; }
+};
+
+#endif //HUFFMANENCRYPT_HUFFMANTUNING_H
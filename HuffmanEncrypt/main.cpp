@@ -6,13 +6,536 @@
 #include <vector>
 #include <bitset>
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <iomanip>
+#include <chrono>
+#include <filesystem>
 #include <omp.h>
 #include "Sampletxtfile/huffmanCompress.h"
 #include "Sampletxtfile/huffmanCompressPar.h"
+#include "Sampletxtfile/huffmanDecompressPar.h"
+#include "Sampletxtfile/huffmanBlockCompressor.h"
+#include "Sampletxtfile/huffmanMemory.h"
+#include "Sampletxtfile/huffmanDaemon.h"
+#include "Sampletxtfile/huffmanCpu.h"
+#include "Sampletxtfile/huffmanNuma.h"
+#include "Sampletxtfile/huffmanCache.h"
+#include "Sampletxtfile/huffmanTuning.h"
 
-int main() {
+static void printUsage(const char* prog) {
+    std::cout << "Cach dung: " << prog << " -c|-d <input> <output> [tuy chon]" << std::endl;
+    std::cout << "           " << prog << " -t <input>" << std::endl;
+    std::cout << "           " << prog << " --legacy -d <input.huff> <output> | --legacy -t <input.huff> [--threads=N]" << std::endl;
+    std::cout << "           " << prog << " --daemon=<socket> [--threads=N]" << std::endl;
+    std::cout << "           " << prog << " --connect=<socket> -c|-d <input> <output> [--shm] | --stats | --shutdown" << std::endl;
+    std::cout << "           " << prog << " --numa-bench <input> [output] [--threads=N]" << std::endl;
+    std::cout << "           " << prog << " --stage-bench <input> [output] [--threads=N]" << std::endl;
+    std::cout << "           " << prog << " --scaling <input> [output] [--threads=N] [--csv=FILE]" << std::endl;
+    std::cout << "           mpirun -np R " << prog << " --mpi -c <input> <output> [--block-size=N] [--threads=N]" << std::endl;
+    std::cout << "  -c                 Nen file theo dinh dang block (HUFB)" << std::endl;
+    std::cout << "  -d                 Giai nen file HUFB" << std::endl;
+    std::cout << "  -t                 Kiem tra file HUFB (giai ma song song, so checksum CRC32C, khong ghi file)" << std::endl;
+    std::cout << "  --legacy           (voi -d / -t) File .huff dinh dang cu (1 luong bit, ca output.huff cua demo): giai ma song song kieu doan (speculative)" << std::endl;
+    std::cout << "  --pipeline         Doc / nen / ghi chong lap theo block (tu bat khi input/output la \"-\")" << std::endl;
+    std::cout << "  --dry-run          (voi -c) Chi tinh kich thuoc nen chinh xac, khong ghi file" << std::endl;
+    std::cout << "  --level=L          Muc nen: exact (mac dinh) | fast (bang ma tu mau du lieu)" << std::endl;
+    std::cout << "  --block-size=N     Kich thuoc block (byte)" << std::endl;
+    std::cout << "  --symbols=B        Ky hieu khi nen: 8 (byte, mac dinh) | 16 (byte + cap byte hay gap)" << std::endl;
+    std::cout << "  --threads=N        So luong (mac dinh: tu chon theo kich thuoc input)" << std::endl;
+    std::cout << "  --io=B             Backend I/O: auto | uring | sync (pread/pwrite)" << std::endl;
+    std::cout << "  --mmap             (voi -c) Nen thang vao file output anh xa bo nho, khong qua buffer trung gian" << std::endl;
+    std::cout << "  --max-memory=S     Ngan sach bo nho (vd 256M, 2G): chon pipeline, so worker va kich thuoc block cho vua" << std::endl;
+    std::cout << "  --cache[=DIR]      (voi -c, muc exact) Dung lai block da nen co cung noi dung (cache tren dia, LRU)" << std::endl;
+    std::cout << "  --cache-size=S     Gioi han dung luong cache (mac dinh 1G)" << std::endl;
+    std::cout << "  --kernel=K         Kernel giai ma: auto | scalar | avx2" << std::endl;
+    std::cout << "  --isa=L            Tap lenh toi da cho cac kernel: auto | generic | sse4.2 | avx2" << std::endl;
+    std::cout << "  --cpu-info         In tinh nang CPU va bien the kernel dang chon" << std::endl;
+    std::cout << "  --daemon=S         Chay daemon nen tai Unix socket S (worker va bang ma luon san sang)" << std::endl;
+    std::cout << "  --connect=S        Gui yeu cau toi daemon tai S; --shm: truyen du lieu qua vung nho chia se" << std::endl;
+    std::cout << "  --numa-bench       Do kha nang mo rong cua bo nen OpenMP theo so luong, co / khong ghim luong NUMA" << std::endl;
+    std::cout << "  --stage-bench      Do tung cong doan nen / giai nen block kem bo dem phan cung (perf_event)" << std::endl;
+    std::cout << "  --scaling          Do strong / weak scaling cua engine OpenMP tu 1 den N luong, xuat CSV theo tung buoc" << std::endl;
+    std::cout << "  --csv=FILE         (voi --scaling) Ghi CSV ra file thay vi stdout" << std::endl;
+    std::cout << "  --mpi              (voi -c, chay bang mpirun) Chia file cho cac rank, bang ma chung, ghi collective 1 file" << std::endl;
+}
+
+// Số nguyên không âm trong [0, maxValue]; false với chuỗi rỗng, ký tự lạ hoặc giá trị quá lớn
+static bool parseCount(const std::string& text, size_t maxValue, size_t& value) {
+    if (text.empty()) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        size_t digit = c - '0';
+        if (value > (maxValue - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+// Gửi yêu cầu tới daemon thay vì tự nén trong tiến trình này
+static int runDaemonClient(const std::string& socketPath, const std::string& mode, const std::string& input,
+                           const std::string& output, bool useShm, bool showStats, bool shutdown) {
+    std::string reply;
+    if (showStats || shutdown) {
+        if (!daemonRequest(socketPath, showStats ? DAEMON_STATS : DAEMON_SHUTDOWN, "", reply, false)) return 1;
+        std::cout << reply;
+        return 0;
+    }
+
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+        std::cerr << "Loi: Khong the mo file input!" << std::endl;
+        return 1;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    DaemonOp op = mode == "-c" ? DAEMON_COMPRESS : DAEMON_DECOMPRESS;
+    if (!daemonRequest(socketPath, op, data, reply, useShm)) return 1;
+
+    std::ofstream out(output, std::ios::binary);
+    out.write(reply.data(), reply.size());
+    std::cout << "Daemon: " << data.size() << " -> " << reply.size() << " bytes" << std::endl;
+    return out ? 0 : 1;
+}
+
+// Đo thời gian nén của HuffmanCompressorPar (tốt nhất trong 3 lần, sau 1 lần chạy làm nóng) theo số luồng,
+// có và không có chế độ NUMA. Mỗi cấu hình dùng context mới để trang nhớ được chạm lần đầu bởi đúng nhóm luồng.
+static double timeParCompress(const std::string& input, const std::string& output, int threads, bool numa) {
+    HuffmanCompressorPar compressor;
+    compressor.setThreads(threads);
+    compressor.setNumaAware(numa);
+    HuffmanContext ctx;
+
+    // Bộ nén in từng bước ra cout: tắt trong lúc đo (lỗi vẫn ra cerr)
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    double best = -1;
+    for (int run = 0; run < 4; run++) {
+        auto start = std::chrono::steady_clock::now();
+        compressor.compress(input, output, ctx);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (run > 0 && (best < 0 || ms < best)) best = ms;
+    }
+    std::cout.rdbuf(saved);
+    std::cout.clear();
+    return best;
+}
+
+static int runNumaBenchmark(const std::string& input, std::string output, int maxThreads) {
+    std::ifstream in(input, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::cerr << "Loi: Khong the mo file input!" << std::endl;
+        return 1;
+    }
+    long long inputSize = (long long)in.tellg();
+#ifdef _WIN32
+    if (output.empty()) output = "NUL";
+#else
+    if (output.empty()) output = "/dev/null";
+#endif
+
+    int nodes = NumaTopology::instance().nodes();
+    std::cout << "NUMA benchmark: " << input << " (" << inputSize << " bytes)" << std::endl;
+    std::cout << "Topology: " << numaDescribe() << std::endl;
+    if (nodes == 1) std::cout << "Chi co 1 node NUMA: cot NUMA chi the hien tac dong cua viec ghim luong" << std::endl;
+
+    std::vector<int> threadCounts;
+    for (int p = 1; p < maxThreads; p *= 2) threadCounts.push_back(p);
+    threadCounts.push_back(maxThreads);
+
+    std::cout << std::setw(6) << "Luong" << std::setw(6) << "Node" << std::setw(12) << "Thuong (ms)"
+              << std::setw(11) << "NUMA (ms)" << std::setw(14) << "Tang toc"
+              << std::setw(14) << "Tang toc NUMA" << std::setw(13) << "NUMA/thuong" << std::endl;
+    double baseline = 0;
+    for (int p : threadCounts) {
+        double plain = timeParCompress(input, output, p, false);
+        double numa = timeParCompress(input, output, p, true);
+        if (plain <= 0 || numa <= 0) return 1;
+        if (p == 1) baseline = plain;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(6) << p << std::setw(6) << std::min(p, nodes)
+                  << std::setw(12) << plain << std::setw(11) << numa
+                  << std::setw(13) << baseline / plain << "x" << std::setw(13) << baseline / numa << "x"
+                  << std::setw(12) << plain / numa << "x" << std::endl;
+    }
+    return 0;
+}
+
+// ===================== ĐO KHẢ NĂNG MỞ RỘNG =====================
+// Strong scaling: cùng 1 input, tăng số luồng. Weak scaling: mỗi luồng giữ cùng lượng dữ liệu (input = p x phần
+// của 1 luồng). Mỗi cấu hình lấy lần chạy nhanh nhất trong 3 lần (sau 1 lần làm nóng), ghi từng bước ra CSV.
+
+static const char* SCALING_STAGES[] = {"read", "histogram", "build", "encode", "write", "total"};
+
+static long long stageMicros(const StageTimes& t, int stage) {
+    switch (stage) {
+        case 0: return t.read;
+        case 1: return t.histogram;
+        case 2: return t.build;
+        case 3: return t.encode;
+        case 4: return t.write;
+        default: return t.total();
+    }
+}
+
+static StageTimes timeParStages(const std::string& input, const std::string& output, int threads) {
+    HuffmanCompressorPar compressor;
+    compressor.setThreads(threads);
+    HuffmanContext ctx;
+
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    StageTimes best;
+    for (int run = 0; run < 4; run++) {
+        compressor.compress(input, output, ctx);
+        if (run == 1 || (run > 1 && ctx.times.total() < best.total())) best = ctx.times;
+    }
+    std::cout.rdbuf(saved);
+    std::cout.clear();
+    return best;
+}
+
+// Engine tuần tự giữ tần suất và cây trong đối tượng: mỗi lần chạy dùng 1 đối tượng mới
+static StageTimes timeSeqStages(const std::string& input, const std::string& output) {
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    StageTimes best;
+    for (int run = 0; run < 4; run++) {
+        HuffmanCompressor compressor;
+        compressor.compress(input, output);
+        if (run == 1 || (run > 1 && compressor.stageTimes().total() < best.total())) best = compressor.stageTimes();
+    }
+    std::cout.rdbuf(saved);
+    std::cout.clear();
+    return best;
+}
+
+// Strong: speedup S = T1 / Tp, hiệu suất S / p, phần tuần tự theo Karp-Flatt (1/S - 1/p) / (1 - 1/p).
+// Weak: hiệu suất T1 / Tp, speedup mở rộng p x hiệu suất, phần tuần tự theo Gustafson (p - S) / (p - 1).
+static void writeScalingRows(std::ostream& csv, const char* mode, size_t bytes, int p, const StageTimes& base,
+                             const StageTimes& t, const StageTimes* seq) {
+    bool weak = std::strcmp(mode, "weak") == 0;
+    for (int stage = 0; stage < 6; stage++) {
+        long long t1 = stageMicros(base, stage), tp = stageMicros(t, stage);
+        csv << mode << ",par," << bytes << "," << p << "," << SCALING_STAGES[stage] << "," << tp << ",";
+        if (t1 > 0 && tp > 0) {
+            double ratio = (double)t1 / tp;
+            double speedup = weak ? p * ratio : ratio;
+            double efficiency = weak ? ratio : ratio / p;
+            csv << std::fixed << std::setprecision(3) << speedup << "," << efficiency << ",";
+            if (p > 1) csv << (weak ? (p - speedup) / (p - 1) : (1 / speedup - 1.0 / p) / (1 - 1.0 / p));
+        } else {
+            csv << ",,";
+        }
+        csv << ",";
+        // So với engine tuần tự chỉ có nghĩa ở tổng (engine tuần tự gộp đọc file vào bước đếm tần suất)
+        if (seq && stage == 5 && tp > 0) csv << std::fixed << std::setprecision(3) << (double)seq->total() / tp;
+        csv << std::endl;
+    }
+}
+
+static bool writePrefix(const std::string& path, const std::string& data, size_t bytes) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), (std::streamsize)bytes);
+    return (bool)out;
+}
+
+static int runScalingStudy(const std::string& input, std::string output, int maxThreads, const std::string& csvPath) {
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+        std::cerr << "Loi: Khong the mo file input!" << std::endl;
+        return 1;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.empty()) {
+        std::cerr << "Loi: File input trong!" << std::endl;
+        return 1;
+    }
+#ifdef _WIN32
+    if (output.empty()) output = "NUL";
+#else
+    if (output.empty()) output = "/dev/null";
+#endif
+
+    std::ofstream csvFile;
+    if (!csvPath.empty()) {
+        csvFile.open(csvPath);
+        if (!csvFile) {
+            std::cerr << "Loi: Khong the ghi file CSV!" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& csv = csvPath.empty() ? std::cout : csvFile;
+
+    // Các input con là phần đầu của file input, ghi ra thư mục tạm
+    std::error_code ec;
+    std::filesystem::path tempDir = std::filesystem::temp_directory_path(ec);
+    if (ec) tempDir = ".";
+    std::string tag = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::vector<std::string> tempFiles;
+    auto prefixFile = [&](size_t bytes) {
+        if (bytes == data.size()) return input;
+        std::string path = (tempDir / ("huffman-scaling-" + tag + "-" + std::to_string(bytes) + ".bin")).string();
+        if (std::find(tempFiles.begin(), tempFiles.end(), path) == tempFiles.end()) {
+            if (!writePrefix(path, data, bytes)) return std::string();
+            tempFiles.push_back(path);
+        }
+        return path;
+    };
+
+    csv << "mode,engine,bytes,threads,stage,us,speedup,efficiency,serial_fraction,speedup_vs_seq" << std::endl;
+    bool ok = true;
+
+    // Strong scaling trên input đầy đủ, 1/4 và 1/16 (bỏ input dưới 64 KB: toàn chi phí cố định)
+    for (size_t divisor : {1, 4, 16}) {
+        size_t bytes = data.size() / divisor;
+        if (divisor > 1 && bytes < (64 << 10)) continue;
+        std::string path = prefixFile(bytes);
+        if (path.empty()) {
+            ok = false;
+            break;
+        }
+        std::cerr << "Strong scaling: " << formatMemorySize(bytes) << std::endl;
+
+        StageTimes seq = timeSeqStages(path, output);
+        csv << "strong,seq," << bytes << ",1,total," << seq.total() << ",,,," << std::endl;
+        StageTimes base;
+        for (int p = 1; p <= maxThreads; p++) {
+            StageTimes t = timeParStages(path, output, p);
+            if (p == 1) base = t;
+            writeScalingRows(csv, "strong", bytes, p, base, t, &seq);
+        }
+    }
+
+    // Weak scaling: mỗi luồng 1 phần maxThreads của file
+    size_t perThread = data.size() / maxThreads;
+    if (ok && perThread > 0) {
+        std::cerr << "Weak scaling: " << formatMemorySize(perThread) << " / luong" << std::endl;
+        StageTimes base;
+        for (int p = 1; p <= maxThreads && ok; p++) {
+            std::string path = prefixFile(perThread * p);
+            if (path.empty()) {
+                ok = false;
+                break;
+            }
+            StageTimes t = timeParStages(path, output, p);
+            if (p == 1) base = t;
+            writeScalingRows(csv, "weak", perThread * p, p, base, t, nullptr);
+        }
+    }
+
+    for (const std::string& path : tempFiles) std::filesystem::remove(path, ec);
+    if (!ok) {
+        std::cerr << "Loi: Khong the ghi file tam!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Chế độ dòng lệnh cho định dạng block
+static int runCli(int argc, char* argv[]) {
+    std::string mode, input, output;
+    bool dryRun = false;
+    bool pipeline = false;
+    bool cpuInfo = false;
+    std::string daemonSocket, connectSocket;
+    bool useShm = false, showStats = false, shutdown = false;
+    bool numaBench = false;
+    bool stageBench = false;
+    bool scaling = false;
+    std::string csvPath;
+    bool mpi = false;
+    bool legacy = false;
+    std::string cacheDir;
+    size_t cacheLimit = BlockCache::DEFAULT_LIMIT;
+    int threads = 0;
+    HuffmanBlockCompressor blockCompressor;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-c" || arg == "-d" || arg == "-t") mode = arg;
+        else if (arg == "--dry-run") dryRun = true;
+        else if (arg == "--pipeline") pipeline = true;
+        else if (arg == "--mmap") blockCompressor.setOutputMode(OutputMode::Mmap);
+        else if (arg == "--level=fast") blockCompressor.setLevel(CompressionLevel::Fast);
+        else if (arg == "--level=exact") blockCompressor.setLevel(CompressionLevel::Exact);
+        else if (arg.rfind("--threads=", 0) == 0) {
+            size_t count = 0;
+            if (!parseCount(arg.substr(10), 4096, count)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            threads = (int)count;
+            blockCompressor.setThreads(threads);
+        }
+        else if (arg.rfind("--daemon=", 0) == 0) daemonSocket = arg.substr(9);
+        else if (arg.rfind("--connect=", 0) == 0) connectSocket = arg.substr(10);
+        else if (arg == "--shm") useShm = true;
+        else if (arg == "--stats") showStats = true;
+        else if (arg == "--shutdown") shutdown = true;
+        else if (arg.rfind("--block-size=", 0) == 0) {
+            size_t blockBytes = 0;
+            if (!parseCount(arg.substr(13), SIZE_MAX, blockBytes)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            blockCompressor.setBlockSize(blockBytes);
+        }
+        else if (arg.rfind("--max-memory=", 0) == 0) {
+            size_t budget = 0;
+            if (!parseMemorySize(arg.substr(13), budget)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            if (budget < HUFB_MIN_MEMORY_BUDGET) {
+                std::cerr << "Loi: --max-memory qua nho (toi thieu " << formatMemorySize(HUFB_MIN_MEMORY_BUDGET) << ")!" << std::endl;
+                return 1;
+            }
+            blockCompressor.setMaxMemory(budget);
+        }
+        else if (arg == "--io=auto") blockCompressor.setIoBackend(IoBackendKind::Auto);
+        else if (arg == "--io=uring") blockCompressor.setIoBackend(IoBackendKind::IoUring);
+        else if (arg == "--io=sync") blockCompressor.setIoBackend(IoBackendKind::Sync);
+        else if (arg == "--symbols=8") blockCompressor.setSymbolMode(SymbolMode::Byte);
+        else if (arg == "--symbols=16") blockCompressor.setSymbolMode(SymbolMode::Pair);
+        else if (arg == "--kernel=scalar") blockCompressor.setDecodeKernel(DecodeKernel::Scalar);
+        else if (arg == "--kernel=avx2") blockCompressor.setDecodeKernel(DecodeKernel::Avx2);
+        else if (arg == "--kernel=auto") blockCompressor.setDecodeKernel(DecodeKernel::Auto);
+        else if (arg.rfind("--isa=", 0) == 0) {
+            CpuLevel level;
+            if (!parseCpuLevel(arg.substr(6), level)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            setCpuLevel(level);
+        }
+        else if (arg == "--cpu-info") cpuInfo = true;
+        else if (arg == "--numa-bench") numaBench = true;
+        else if (arg == "--stage-bench") stageBench = true;
+        else if (arg == "--scaling") scaling = true;
+        else if (arg.rfind("--csv=", 0) == 0) csvPath = arg.substr(6);
+        else if (arg == "--mpi") mpi = true;
+        else if (arg == "--legacy") legacy = true;
+        else if (arg == "--cache") cacheDir = BlockCache::defaultDirectory();
+        else if (arg.rfind("--cache=", 0) == 0) cacheDir = arg.substr(8);
+        else if (arg.rfind("--cache-size=", 0) == 0) {
+            if (!parseMemorySize(arg.substr(13), cacheLimit)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg != "-" && arg.rfind("-", 0) == 0) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        else if (input.empty()) input = arg;
+        else if (output.empty()) output = arg;
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (cpuInfo) {
+        std::cout << cpuKernelReport();
+        if (mode.empty()) return 0;
+    }
+
+    if (numaBench) {
+        if (input.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return runNumaBenchmark(input, output, threads > 0 ? threads : omp_get_max_threads());
+    }
+
+    if (scaling) {
+        if (input.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return runScalingStudy(input, output, threads > 0 ? threads : omp_get_max_threads(), csvPath);
+    }
+
+    if (stageBench) {
+        if (input.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+#ifdef _WIN32
+        if (output.empty()) output = "NUL";
+#else
+        if (output.empty()) output = "/dev/null";
+#endif
+        return blockCompressor.benchmarkStages(input, output) ? 0 : 1;
+    }
+
+    if (legacy) {
+        if ((mode != "-d" && mode != "-t") || input.empty() || (mode == "-d" && output.empty())) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        HuffmanDecompressorPar legacyDecompressor;
+        legacyDecompressor.setThreads(threads);
+        return legacyDecompressor.decompress(input, mode == "-d" ? output : "") ? 0 : 1;
+    }
+
+    BlockCache blockCache;
+    if (!cacheDir.empty() && mode == "-c") {
+        if (!blockCache.open(cacheDir, cacheLimit)) {
+            std::cerr << "Loi: Khong the mo thu muc cache " << cacheDir << std::endl;
+            return 1;
+        }
+        blockCompressor.setCache(&blockCache);
+    }
+
+    if (mpi) {
+        if (mode != "-c" || input.empty() || output.empty() || input == "-" || output == "-") {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return blockCompressor.compressMpi(input, output) ? 0 : 1;
+    }
+
+    if (!daemonSocket.empty()) {
+        HuffmanDaemon daemon(daemonSocket, threads > 0 ? threads : omp_get_max_threads());
+        return daemon.run() ? 0 : 1;
+    }
+    if (!connectSocket.empty()) {
+        if (!showStats && !shutdown && (mode.empty() || mode == "-t" || input.empty() || output.empty())) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return runDaemonClient(connectSocket, mode, input, output, useShm, showStats, shutdown);
+    }
+
+    if (mode == "-c" && dryRun && !input.empty()) {
+        uint64_t compressedSize = 0;
+        return blockCompressor.estimate(input, compressedSize) ? 0 : 1;
+    }
+
+    if (mode.empty() || input.empty() || (output.empty() && mode != "-t")) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    bool ok;
+    if (mode == "-t") {
+        ok = blockCompressor.test(input);
+    } else if (pipeline || input == "-" || output == "-") {
+        ok = mode == "-c" ? blockCompressor.compressPipelined(input, output)
+                          : blockCompressor.decompressPipelined(input, output);
+    } else {
+        ok = mode == "-c" ? blockCompressor.compress(input, output) : blockCompressor.decompress(input, output);
+    }
+
+    // Bộ nhớ đỉnh của lần chạy (khi output là stdout thì in ra stderr)
+    std::ostream& log = output == "-" ? std::cerr : std::cout;
+    log << "Bo nho dinh (peak RSS): " << formatMemorySize(peakMemoryBytes()) << std::endl;
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    // Chương trình dòng lệnh (và daemon): mô hình song song đã đo được dùng lại giữa các lần chạy
+    ParallelTuner::enableDiskCache();
+    if (argc > 1) return runCli(argc, argv);
 
     // File .txt đầu vào và file .huff đầu ra
     std::string input = "C:\\Users\\dinhd\\OneDrive\\Desktop\\HuffmanEncrypt\\Sampletxtfile\\1MB.txt";
@@ -0,0 +1,332 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+// Microbenchmark từng kernel, không có I/O: histogram + CRC32C, dựng độ dài mã, gán mã chuẩn tắc,
+// mã hóa / đóng gói bit, dựng bảng giải mã và giải mã. Mỗi kernel chạy với mọi biến thể CPU có
+// (generic / sse4.2 / bmi2 / avx2) và số luồng bit (1 / 8) trên các phân bố ký tự cố định, với input
+// nằm trong cache và input lớn hơn cache. Kết quả là ns/byte và cycles/byte (lần nhanh nhất).
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <chrono>
+#include "Sampletxtfile/huffmanBlock.h"
+#include "Sampletxtfile/huffmanChecksum.h"
+#include "Sampletxtfile/huffmanCpu.h"
+#include "Sampletxtfile/huffmanMemory.h"
+#include "Sampletxtfile/huffmanPerf.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define MICROBENCH_HAVE_TSC 1
+#endif
+
+static const size_t IN_CACHE_SIZE = 32 * 1024;        // Vừa L1d / L2
+static const size_t OUT_OF_CACHE_SIZE = 64u << 20;    // Lớn hơn LLC thông thường
+static const size_t BENCH_BLOCK_SIZE = 128 * 1024;    // Kích thước block mặc định của định dạng HUFB
+static const size_t SINGLE_STREAM_BLOCK = HUF_MIN_MULTI_STREAM - 1; // Block nhỏ hơn ngưỡng chỉ có 1 luồng bit
+static const int BENCH_REPS = 5;
+
+// Kết quả được cộng vào đây để trình biên dịch không bỏ được phép tính
+static volatile uint64_t sink;
+
+// ===================== DỮ LIỆU =====================
+
+struct Distribution {
+    const char* name;
+    double ratio; // Xác suất ký tự thứ s tỉ lệ với ratio^s (1 = đều)
+};
+
+// uniform: mã 8 bit; text: khoảng 4-5 bit / ký tự như văn bản; skewed: mã rất ngắn, vài mã chạm giới hạn 12 bit
+static const Distribution DISTRIBUTIONS[] = {{"uniform", 1.0}, {"text", 0.93}, {"skewed", 0.55}};
+
+static std::vector<unsigned char> generate(const Distribution& dist, size_t n) {
+    // Bảng tra 65536 phần tử theo hàm phân phối tích lũy, lấy mẫu bằng 16 bit ngẫu nhiên
+    std::vector<double> weight(256);
+    double sum = 0, w = 1;
+    for (int s = 0; s < 256; s++, w *= dist.ratio) sum += weight[s] = w;
+    std::vector<unsigned char> lookup(65536);
+    double cumulative = 0;
+    size_t pos = 0;
+    for (int s = 0; s < 256; s++) {
+        cumulative += weight[s] / sum;
+        size_t until = s == 255 ? lookup.size() : std::min(lookup.size(), (size_t)(cumulative * lookup.size()));
+        for (; pos < until; pos++) lookup[pos] = (unsigned char)s;
+    }
+
+    std::vector<unsigned char> data(n);
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(dist.ratio * 1e6);
+    for (size_t i = 0; i < n; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        data[i] = lookup[state >> 48];
+    }
+    return data;
+}
+
+// ===================== ĐO =====================
+
+struct BenchResult {
+    double nsPerCall = 0;
+    double cyclesPerCall = 0;
+    bool haveCycles = false;
+};
+
+static uint64_t readTsc() {
+#ifdef MICROBENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Chạy body đủ số lần để mỗi lượt đo dài ít nhất minMs / BENCH_REPS, lấy lượt nhanh nhất.
+// Cycles lấy từ bộ đếm phần cứng nếu có, nếu không thì từ TSC (tần số danh định, không theo turbo).
+template <typename F>
+static BenchResult runBench(F&& body, double minMs) {
+    body(); // Làm nóng: cache, bảng giải mã, trang nhớ
+    long long calls = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < calls; i++) body();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (ms >= minMs / BENCH_REPS || calls >= (1LL << 40)) break;
+        calls = ms > 0 ? std::max(calls * 2, (long long)(calls * (minMs / BENCH_REPS) / ms) + 1) : calls * 16;
+    }
+
+    BenchResult best;
+    best.nsPerCall = -1;
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        uint64_t tsc = readTsc();
+        PerfStage stage;
+        for (long long i = 0; i < calls; i++) body();
+        stage.stop();
+        tsc = readTsc() - tsc;
+
+        double ns = stage.seconds * 1e9 / calls;
+        if (best.nsPerCall >= 0 && ns >= best.nsPerCall) continue;
+        best.nsPerCall = ns;
+        if (stage.counters.valid[PERF_CYCLES]) {
+            best.cyclesPerCall = (double)stage.counters.value[PERF_CYCLES] / calls;
+            best.haveCycles = true;
+        } else {
+#ifdef MICROBENCH_HAVE_TSC
+            best.cyclesPerCall = (double)tsc / calls;
+            best.haveCycles = true;
+#endif
+        }
+    }
+    return best;
+}
+
+static void printRow(const std::string& kernel, const std::string& variant, const std::string& dist,
+                     const std::string& size, const BenchResult& r, double bytesPerCall) {
+    std::cout << std::left << std::setw(14) << kernel << std::setw(16) << variant << std::setw(9) << dist
+              << std::setw(8) << size << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << r.nsPerCall << std::setprecision(3) << std::setw(10) << r.nsPerCall / bytesPerCall;
+    if (r.haveCycles) std::cout << std::setw(10) << r.cyclesPerCall / bytesPerCall;
+    else std::cout << std::setw(10) << "-";
+    std::cout << std::endl;
+}
+
+// Biến thể CPU của kernel histogram / đóng gói bit / giải mã: chọn bằng mức tập lệnh tối đa (huffmanCpu.h)
+struct CpuVariant {
+    const char* name;
+    CpuLevel level;
+    CpuFeature needs;
+    bool generic;
+};
+
+static bool variantSupported(const CpuVariant& v) {
+    return v.generic || cpuDetected(v.needs);
+}
+
+// ===================== KERNEL =====================
+
+// Bảng mã chung dựng từ toàn bộ dữ liệu, như mức Fast: mọi block dùng cùng 1 bảng
+static void buildTable(const std::vector<unsigned char>& data, HuffmanTable& table) {
+    uint32_t freq[256] = {0};
+    for (unsigned char c : data) freq[c]++;
+    for (int s = 0; s < 256; s++) freq[s] += 1;
+    buildCodeLengths(freq, table.codeLen);
+    buildCanonicalCodes(table);
+}
+
+struct EncodedBlocks {
+    std::vector<unsigned char> packed;
+    std::vector<size_t> offset, size, rawOffset, rawSize;
+};
+
+static void encodeAll(const std::vector<unsigned char>& data, size_t block, const HuffmanTable& table,
+                      EncodedBlocks& out) {
+    out.packed.resize((data.size() / block + 1) * maxHuffmanBlockSize(block));
+    out.offset.clear();
+    out.size.clear();
+    out.rawOffset.clear();
+    out.rawSize.clear();
+    size_t pos = 0;
+    for (size_t off = 0; off < data.size(); off += block) {
+        size_t n = std::min(block, data.size() - off);
+        size_t written = encodeHuffmanBlock(data.data() + off, n, table, out.packed.data() + pos);
+        out.offset.push_back(pos);
+        out.size.push_back(written);
+        out.rawOffset.push_back(off);
+        out.rawSize.push_back(n);
+        pos += written;
+    }
+}
+
+static void benchDistribution(const Distribution& dist, size_t largeSize, double minMs) {
+    const CpuVariant histVariants[] = {{"generic", CpuLevel::Generic, CPU_SSE42, true},
+                                       {"sse4.2", CpuLevel::Sse42, CPU_SSE42, false}};
+    const CpuVariant packVariants[] = {{"generic", CpuLevel::Generic, CPU_BMI2, true},
+                                       {"bmi2", CpuLevel::Auto, CPU_BMI2, false}};
+    const struct { size_t bytes; const char* name; } sizes[] = {{IN_CACHE_SIZE, "cache"}, {largeSize, "ram"}};
+
+    for (const auto& size : sizes) {
+        std::vector<unsigned char> data = generate(dist, size.bytes);
+        HuffmanTable table;
+        buildTable(data, table);
+
+        // Histogram + CRC32C theo block (countBlockHistogram đếm riêng từng luồng bit như khi nén)
+        for (const CpuVariant& v : histVariants) {
+            if (!variantSupported(v)) continue;
+            setCpuLevel(v.level);
+            BlockHistogram hist;
+            BenchResult r = runBench([&] {
+                for (size_t off = 0; off < data.size(); off += BENCH_BLOCK_SIZE) {
+                    countBlockHistogram(data.data() + off, std::min(BENCH_BLOCK_SIZE, data.size() - off), hist);
+                    sink = sink + hist.checksum;
+                }
+            }, minMs);
+            printRow("histogram", v.name, dist.name, size.name, r, (double)data.size());
+        }
+
+        // Mã hóa / đóng gói bit: 1 luồng (block < HUF_MIN_MULTI_STREAM) và 8 luồng
+        for (size_t block : {SINGLE_STREAM_BLOCK, BENCH_BLOCK_SIZE}) {
+            std::string streams = block == SINGLE_STREAM_BLOCK ? "/1" : "/8";
+            for (const CpuVariant& v : packVariants) {
+                if (!variantSupported(v)) continue;
+                setCpuLevel(v.level);
+                EncodedBlocks encoded;
+                BenchResult r = runBench([&] {
+                    encodeAll(data, block, table, encoded);
+                    sink = sink + encoded.packed[0];
+                }, minMs);
+                printRow("encode", std::string(v.name) + streams, dist.name, size.name, r, (double)data.size());
+            }
+        }
+
+        // Giải mã: bộ giải mã vô hướng (generic / bmi2) và AVX2 (8 luồng trên 8 lane), 1 và 8 luồng bit
+        for (size_t block : {SINGLE_STREAM_BLOCK, BENCH_BLOCK_SIZE}) {
+            std::string streams = block == SINGLE_STREAM_BLOCK ? "/1" : "/8";
+            setCpuLevel(CpuLevel::Auto);
+            EncodedBlocks encoded;
+            encodeAll(data, block, table, encoded);
+            std::vector<unsigned char> decoded(data.size());
+
+            const struct { const char* name; CpuLevel level; DecodeKernel kernel; CpuFeature needs; bool generic; }
+                decodeVariants[] = {{"generic", CpuLevel::Generic, DecodeKernel::Scalar, CPU_BMI2, true},
+                                    {"bmi2", CpuLevel::Auto, DecodeKernel::Scalar, CPU_BMI2, false},
+                                    {"avx2", CpuLevel::Auto, DecodeKernel::Avx2, CPU_AVX2, false}};
+            for (const auto& v : decodeVariants) {
+                if (!v.generic && !cpuDetected(v.needs)) continue;
+                setCpuLevel(v.level);
+                bool ok = true;
+                BenchResult r = runBench([&] {
+                    for (size_t b = 0; b < encoded.offset.size(); b++) {
+                        ok = decodeHuffmanBlock(encoded.packed.data() + encoded.offset[b], encoded.size[b],
+                                                decoded.data() + encoded.rawOffset[b], encoded.rawSize[b],
+                                                v.kernel) && ok;
+                    }
+                }, minMs);
+                if (!ok || decoded != data) {
+                    std::cerr << "Loi: Giai ma sai (" << v.name << streams << ", " << dist.name << ")" << std::endl;
+                    continue;
+                }
+                printRow("decode", std::string(v.name) + streams, dist.name, size.name, r, (double)data.size());
+            }
+        }
+        setCpuLevel(CpuLevel::Auto);
+    }
+
+    // Các bước dựng bảng chạy 1 lần mỗi block: ns/call, ns/byte và cycles/byte chia theo 1 block 128 KB
+    std::vector<unsigned char> data = generate(dist, BENCH_BLOCK_SIZE);
+    BlockHistogram hist;
+    countBlockHistogram(data.data(), data.size(), hist);
+    HuffmanTable table;
+    BenchResult r = runBench([&] {
+        buildCodeLengths(hist.freq, table.codeLen);
+        sink = sink + table.codeLen[0];
+    }, minMs);
+    printRow("code-lengths", "two-queue", dist.name, "block", r, (double)BENCH_BLOCK_SIZE);
+
+    r = runBench([&] {
+        buildCanonicalCodes(table);
+        sink = sink + table.code[255];
+    }, minMs);
+    printRow("canonical", "-", dist.name, "block", r, (double)BENCH_BLOCK_SIZE);
+
+    DecodeTable decodeTable;
+    r = runBench([&] {
+        buildDecodeTable(table.codeLen, decodeTable);
+        sink = sink + decodeTable.entry[0];
+    }, minMs);
+    printRow("decode-table", std::to_string(decodeTable.tableBits) + " bit", dist.name, "block", r,
+             (double)BENCH_BLOCK_SIZE);
+}
+
+static void printUsage(const char* prog) {
+    std::cout << "Cach dung: " << prog << " [--large=S] [--min-ms=N] [--dist=D]" << std::endl;
+    std::cout << "  --large=S   Kich thuoc input ngoai cache (mac dinh 64M)" << std::endl;
+    std::cout << "  --min-ms=N  Thoi gian do toi thieu moi dong (mac dinh 200 ms)" << std::endl;
+    std::cout << "  --dist=D    Chi do 1 phan bo: uniform | text | skewed" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t largeSize = OUT_OF_CACHE_SIZE;
+    double minMs = 200;
+    std::string onlyDist;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--large=", 0) == 0 && parseMemorySize(arg.substr(8), largeSize) && largeSize > 0) continue;
+        if (arg.rfind("--min-ms=", 0) == 0 && (minMs = std::atof(arg.c_str() + 9)) > 0) continue;
+        if (arg.rfind("--dist=", 0) == 0) {
+            onlyDist = arg.substr(7);
+            continue;
+        }
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Mở bộ đếm trước khi đo (không dùng được thì cycles lấy từ TSC)
+    PerfCounters& perf = PerfCounters::instance();
+    std::cout << cpuKernelReport();
+    std::cout << "Bo dem phan cung: " << perf.status() << std::endl;
+#ifdef MICROBENCH_HAVE_TSC
+    if (!perf.available()) std::cout << "cyc/B lay tu TSC (tan so danh dinh)" << std::endl;
+#endif
+    std::cout << "Input: cache = " << formatMemorySize(IN_CACHE_SIZE) << ", ram = " << formatMemorySize(largeSize)
+              << "; block " << formatMemorySize(BENCH_BLOCK_SIZE) << " (/8 luong bit) hoac "
+              << SINGLE_STREAM_BLOCK << " byte (/1 luong bit)" << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(14) << "Kernel" << std::setw(16) << "Bien the" << std::setw(9) << "Phan bo"
+              << std::setw(8) << "Input" << std::right << std::setw(12) << "ns/call" << std::setw(10) << "ns/B"
+              << std::setw(10) << "cyc/B" << std::endl;
+    bool found = false;
+    for (const Distribution& dist : DISTRIBUTIONS) {
+        if (!onlyDist.empty() && onlyDist != dist.name) continue;
+        found = true;
+        benchDistribution(dist, largeSize, minMs);
+    }
+    if (!found) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+#ifndef HUFFMANENCRYPT_HUFFMANTEST_H
+#define HUFFMANENCRYPT_HUFFMANTEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Khung test tối giản, không phụ thuộc thư viện ngoài: mỗi TEST_CASE tự đăng ký vào danh sách,
+// CHECK ghi lại lỗi rồi chạy tiếp để 1 lần chạy báo được mọi chỗ sai.
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& testRegistry();
+void testFailed(const char* file, int line, const char* expr);
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*run)()) { testRegistry().push_back({name, run}); }
+};
+
+#define TEST_CASE(name)                                      \
+    static void name();                                      \
+    static TestRegistrar name##Registrar(#name, name);       \
+    static void name()
+
+#define CHECK(expr)                                          \
+    do {                                                     \
+        if (!(expr)) testFailed(__FILE__, __LINE__, #expr);  \
+    } while (0)
+
+// Dữ liệu mẫu có thể tái lập (cùng seed cho cùng kết quả)
+enum class TestData {
+    Text,      // Văn bản tiếng Anh giả: Huffman nén tốt
+    Random,    // Byte ngẫu nhiên đều: không nén được (block stored)
+    Constant,  // 1 ký tự lặp lại (block constant)
+    Words,     // Ít từ lặp lại nhiều: có cặp byte hay gặp (block cặp byte)
+};
+
+std::vector<unsigned char> makeTestData(TestData kind, size_t n, uint32_t seed = 1);
+
+// Đường dẫn file tạm riêng cho tiến trình test; removeTestFile xóa nếu có
+std::string testTempPath(const std::string& name);
+void removeTestFile(const std::string& path);
+bool writeTestFile(const std::string& path, const std::vector<unsigned char>& data);
+bool readTestFile(const std::string& path, std::vector<unsigned char>& data);
+// File mẫu trong tests/data
+std::string testDataPath(const std::string& name);
+
+// Các bản ghi block của 1 file HUFB version 2 (đi từ sau header tới bản ghi kết thúc)
+struct TestBlockRecord {
+    uint8_t type;
+    size_t offset;       // Vị trí header của bản ghi
+    uint32_t rawSize, payloadSize;
+};
+bool listBlockRecords(const std::vector<unsigned char>& file, std::vector<TestBlockRecord>& records);
+
+// Tắt log của các API file (cout) trong phạm vi của đối tượng
+class QuietCout {
+private:
+    std::ostringstream sink;
+    std::streambuf* saved;
+
+public:
+    QuietCout() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietCout() { std::cout.rdbuf(saved); }
+};
+
+#endif //HUFFMANENCRYPT_HUFFMANTEST_H
@@ -0,0 +1,144 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+// API bất đồng bộ (coroutine): round-trip, hủy, dữ liệu hỏng, header khai kích thước quá lớn,
+// chạy tiếp trên executor của người gọi, hàng đợi đầy không chặn luồng gọi
+
+#include "huffmanTest.h"
+#include "../Sampletxtfile/huffmanAsync.h"
+#include "../Sampletxtfile/huffmanBlockCompressor.h"
+#include <atomic>
+#include <cstring>
+#include <future>
+
+using namespace std;
+
+static vector<byte> asByteVector(const vector<unsigned char>& v) {
+    const byte* p = reinterpret_cast<const byte*>(v.data());
+    return vector<byte>(p, p + v.size());
+}
+
+TEST_CASE(asyncRoundTrip) {
+    HuffmanAsync async(2, 1);
+    for (TestData kind : {TestData::Text, TestData::Random, TestData::Constant, TestData::Words}) {
+        vector<byte> raw = asByteVector(makeTestData(kind, 300 * 1024, 21));
+        AsyncResult packed = syncWait(async.compressAsync(raw));
+        CHECK(packed.status == AsyncStatus::Ok);
+        AsyncResult restored = syncWait(async.decompressAsync(packed.data));
+        CHECK(restored.status == AsyncStatus::Ok);
+        CHECK(restored.data == raw);
+    }
+    AsyncResult empty = syncWait(async.compressAsync({}));
+    CHECK(empty.status == AsyncStatus::Ok);
+    AsyncResult emptyRestored = syncWait(async.decompressAsync(empty.data));
+    CHECK(emptyRestored.status == AsyncStatus::Ok && emptyRestored.data.empty());
+}
+
+TEST_CASE(asyncCancelled) {
+    HuffmanAsync async;
+    stop_source stop;
+    stop.request_stop();
+    vector<byte> raw = asByteVector(makeTestData(TestData::Text, 100 * 1024));
+    AsyncResult packed = syncWait(async.compressAsync(raw, stop.get_token()));
+    CHECK(packed.status == AsyncStatus::Cancelled && packed.data.empty());
+}
+
+TEST_CASE(asyncCorruptInput) {
+    HuffmanAsync async;
+    vector<byte> raw = asByteVector(makeTestData(TestData::Text, 300 * 1024, 4));
+    AsyncResult packed = syncWait(async.compressAsync(raw));
+    CHECK(packed.status == AsyncStatus::Ok);
+
+    vector<byte> bad = packed.data;
+    bad[bad.size() / 2] ^= byte{0x20};
+    AsyncResult restored = syncWait(async.decompressAsync(bad));
+    CHECK(restored.status == AsyncStatus::Failed && restored.data.empty());
+
+    vector<byte> truncated(packed.data.begin(), packed.data.begin() + 10);
+    CHECK(syncWait(async.decompressAsync(truncated)).status == AsyncStatus::Failed);
+}
+
+// Kích thước gốc trong header (u64 ở offset 12) không được dùng để cấp phát khi vượt giới hạn
+TEST_CASE(asyncOversizedHeader) {
+    HuffmanAsync async;
+    vector<byte> raw = asByteVector(makeTestData(TestData::Text, 10000));
+    AsyncResult packed = syncWait(async.compressAsync(raw));
+    CHECK(packed.status == AsyncStatus::Ok);
+
+    vector<byte> bad = packed.data;
+    uint64_t huge = 1ull << 52;
+    memcpy(bad.data() + 12, &huge, sizeof(huge));
+    AsyncResult restored = syncWait(async.decompressAsync(bad));
+    CHECK(restored.status == AsyncStatus::Failed);
+
+    // Giới hạn do người gọi đặt: file hợp lệ nhưng lớn hơn giới hạn
+    async.setMaxOutputSize(raw.size() - 1);
+    CHECK(syncWait(async.decompressAsync(packed.data)).status == AsyncStatus::Failed);
+    async.setMaxOutputSize(raw.size());
+    CHECK(syncWait(async.decompressAsync(packed.data)).status == AsyncStatus::Ok);
+}
+
+static HuffmanTask<thread::id> compressThenReportThread(HuffmanAsync& async, vector<byte> raw, bool& ok) {
+    AsyncResult packed = co_await async.compressAsync(std::move(raw));
+    ok = packed.status == AsyncStatus::Ok;
+    co_return this_thread::get_id();
+}
+
+// Executor kiểu event loop: handle được đẩy vào hàng đợi của loop, loop resume trên luồng của nó
+TEST_CASE(asyncResumeExecutor) {
+    BoundedQueue<coroutine_handle<>> loopQueue(16);
+    thread loop([&] {
+        coroutine_handle<> h;
+        while (loopQueue.pop(h)) h.resume();
+    });
+    {
+        HuffmanAsync async;
+        async.setResumeExecutor([&](coroutine_handle<> h) { loopQueue.push(h); });
+        bool ok = false;
+        thread::id resumedOn = syncWait(compressThenReportThread(async, asByteVector(makeTestData(TestData::Text, 50000)), ok));
+        CHECK(ok);
+        CHECK(resumedOn == loop.get_id());
+    }
+    loopQueue.close();
+    loop.join();
+}
+
+// Worker duy nhất bị giữ lại, hàng đợi 1 chỗ: trong 2 việc gửi thêm, đúng 1 việc xếp hàng được,
+// việc còn lại kết thúc ngay với Busy thay vì chặn luồng gọi
+TEST_CASE(asyncQueueFullIsBusy) {
+    promise<void> entered, release;
+    shared_future<void> released = release.get_future().share();
+    atomic<bool> first{true};
+    HuffmanAsync async(1, 1, 1);
+    async.setResumeExecutor([&](coroutine_handle<> h) {
+        if (first.exchange(false)) {
+            entered.set_value();
+            released.wait();
+        }
+        h.resume();
+    });
+
+    vector<byte> raw = asByteVector(makeTestData(TestData::Text, 20000));
+    AsyncStatus blocker = AsyncStatus::Failed;
+    thread blockerThread([&] { blocker = syncWait(async.compressAsync(raw)).status; });
+    entered.get_future().wait();
+
+    atomic<int> busy{0};
+    AsyncStatus status[2] = {AsyncStatus::Failed, AsyncStatus::Failed};
+    vector<thread> senders;
+    for (int i = 0; i < 2; i++) {
+        senders.emplace_back([&, i] {
+            status[i] = syncWait(async.compressAsync(raw)).status;
+            if (status[i] == AsyncStatus::Busy) busy++;
+        });
+    }
+    while (busy.load() == 0) this_thread::yield();
+    release.set_value();
+    for (thread& t : senders) t.join();
+    blockerThread.join();
+
+    CHECK(blocker == AsyncStatus::Ok);
+    CHECK(busy.load() == 1);
+    CHECK((status[0] == AsyncStatus::Ok) != (status[1] == AsyncStatus::Ok));
+}
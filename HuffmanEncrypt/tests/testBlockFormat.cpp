@@ -0,0 +1,170 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+// Round-trip định dạng HUFB: mọi loại dữ liệu x chế độ ký hiệu x mức nén, qua đường file và API trong bộ nhớ
+
+#include "huffmanTest.h"
+#include "../Sampletxtfile/huffmanBlockCompressor.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static const size_t TEST_SIZE = 300 * 1024; // 3 block, block cuối không đầy
+
+struct FormatCase {
+    TestData kind;
+    SymbolMode mode;
+    CompressionLevel level;
+};
+
+static vector<FormatCase> allCases() {
+    vector<FormatCase> cases;
+    for (TestData kind : {TestData::Text, TestData::Random, TestData::Constant, TestData::Words})
+        for (SymbolMode mode : {SymbolMode::Byte, SymbolMode::Pair})
+            for (CompressionLevel level : {CompressionLevel::Exact, CompressionLevel::Fast})
+                cases.push_back({kind, mode, level});
+    return cases;
+}
+
+static bool hasBlockType(const vector<TestBlockRecord>& records, uint8_t type) {
+    return any_of(records.begin(), records.end(), [&](const TestBlockRecord& r) { return r.type == type; });
+}
+
+// Loại block chắc chắn phải xuất hiện ở mức Exact (mỗi block chọn bản ghi nhỏ nhất)
+static void checkExpectedBlocks(const FormatCase& c, const vector<TestBlockRecord>& records) {
+    if (c.level != CompressionLevel::Exact) return;
+    switch (c.kind) {
+        case TestData::Constant:
+            CHECK(hasBlockType(records, BLOCK_CONSTANT));
+            break;
+        case TestData::Random:
+            CHECK(hasBlockType(records, BLOCK_STORED));
+            break;
+        case TestData::Text:
+            CHECK(hasBlockType(records, BLOCK_HUFFMAN) || hasBlockType(records, BLOCK_PAIRS));
+            break;
+        case TestData::Words:
+            CHECK(hasBlockType(records, c.mode == SymbolMode::Pair ? BLOCK_PAIRS : BLOCK_HUFFMAN));
+            break;
+    }
+}
+
+TEST_CASE(blockFormatFileRoundTrip) {
+    string rawPath = testTempPath("format.raw");
+    string packedPath = testTempPath("format.huff");
+    string outPath = testTempPath("format.out");
+    for (const FormatCase& c : allCases()) {
+        vector<unsigned char> raw = makeTestData(c.kind, TEST_SIZE);
+        CHECK(writeTestFile(rawPath, raw));
+
+        HuffmanBlockCompressor compressor;
+        compressor.setSymbolMode(c.mode);
+        compressor.setLevel(c.level);
+        vector<unsigned char> packed, restored;
+        {
+            QuietCout quiet;
+            CHECK(compressor.compress(rawPath, packedPath));
+            CHECK(compressor.test(packedPath));
+            CHECK(compressor.decompress(packedPath, outPath));
+        }
+        CHECK(readTestFile(packedPath, packed));
+        CHECK(readTestFile(outPath, restored));
+        CHECK(restored == raw);
+
+        vector<TestBlockRecord> records;
+        CHECK(listBlockRecords(packed, records));
+        CHECK(records.size() == 4); // 3 block + bản ghi kết thúc
+        checkExpectedBlocks(c, records);
+    }
+    removeTestFile(rawPath);
+    removeTestFile(packedPath);
+    removeTestFile(outPath);
+}
+
+TEST_CASE(blockFormatSpanRoundTrip) {
+    for (const FormatCase& c : allCases()) {
+        vector<unsigned char> raw = makeTestData(c.kind, TEST_SIZE, 7);
+        span<const byte> input(reinterpret_cast<const byte*>(raw.data()), raw.size());
+
+        HuffmanBlockCompressor compressor;
+        compressor.setSymbolMode(c.mode);
+        compressor.setLevel(c.level);
+        vector<byte> packed(compressor.maxCompressedSize(raw.size()));
+        size_t packedSize = 0;
+        CHECK(compressor.compress(input, packed, packedSize));
+        packed.resize(packedSize);
+
+        uint64_t rawSize = 0;
+        CHECK(HuffmanBlockCompressor::decompressedSize(packed, rawSize));
+        CHECK(rawSize == raw.size());
+        vector<byte> restored(rawSize);
+        size_t restoredSize = 0;
+        CHECK(compressor.decompress(packed, restored, restoredSize));
+        CHECK(restoredSize == raw.size());
+        CHECK(memcmp(restored.data(), raw.data(), raw.size()) == 0);
+
+        vector<TestBlockRecord> records;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(packed.data());
+        CHECK(listBlockRecords(vector<unsigned char>(p, p + packed.size()), records));
+        checkExpectedBlocks(c, records);
+    }
+}
+
+// Dữ liệu rỗng, 1 byte, đúng biên block
+TEST_CASE(blockFormatEdgeSizes) {
+    HuffmanBlockCompressor compressor;
+    for (size_t n : {(size_t)0, (size_t)1, HUFB_DEFAULT_BLOCK_SIZE, HUFB_DEFAULT_BLOCK_SIZE + 1}) {
+        vector<unsigned char> raw = makeTestData(TestData::Text, n, 3);
+        span<const byte> input(reinterpret_cast<const byte*>(raw.data()), raw.size());
+        vector<byte> packed(compressor.maxCompressedSize(n));
+        size_t packedSize = 0;
+        CHECK(compressor.compress(input, packed, packedSize));
+        packed.resize(packedSize);
+
+        vector<byte> restored(n);
+        size_t restoredSize = 0;
+        CHECK(compressor.decompress(packed, restored, restoredSize));
+        CHECK(restoredSize == n);
+        CHECK(n == 0 || memcmp(restored.data(), raw.data(), n) == 0);
+    }
+}
+
+// Cùng 1 file giải được bằng mọi kernel giải mã và mọi cách ghi / đọc
+TEST_CASE(blockFormatKernelsAndModes) {
+    string rawPath = testTempPath("modes.raw");
+    string packedPath = testTempPath("modes.huff");
+    string outPath = testTempPath("modes.out");
+    vector<unsigned char> raw = makeTestData(TestData::Text, TEST_SIZE, 11);
+    CHECK(writeTestFile(rawPath, raw));
+
+    for (OutputMode output : {OutputMode::Stream, OutputMode::Mmap}) {
+        HuffmanBlockCompressor compressor;
+        compressor.setOutputMode(output);
+        QuietCout quiet;
+        CHECK(compressor.compress(rawPath, packedPath));
+        for (DecodeKernel kernel : {DecodeKernel::Scalar, DecodeKernel::Auto}) {
+            HuffmanBlockCompressor decoder;
+            decoder.setDecodeKernel(kernel);
+            vector<unsigned char> restored;
+            CHECK(decoder.decompress(packedPath, outPath));
+            CHECK(readTestFile(outPath, restored) && restored == raw);
+        }
+    }
+
+    // Pipeline (kiểu pigz) ghi cùng định dạng
+    {
+        HuffmanBlockCompressor compressor;
+        QuietCout quiet;
+        CHECK(compressor.compressPipelined(rawPath, packedPath));
+        CHECK(compressor.decompressPipelined(packedPath, outPath));
+        vector<unsigned char> restored;
+        CHECK(readTestFile(outPath, restored) && restored == raw);
+        CHECK(compressor.decompress(packedPath, outPath));
+        CHECK(readTestFile(outPath, restored) && restored == raw);
+    }
+    removeTestFile(rawPath);
+    removeTestFile(packedPath);
+    removeTestFile(outPath);
+}
@@ -0,0 +1,116 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+// Phát hiện dữ liệu hỏng: sửa 1 byte trong payload / header / checksum, cắt cụt file, sai magic
+
+#include "huffmanTest.h"
+#include "../Sampletxtfile/huffmanBlockCompressor.h"
+
+using namespace std;
+
+static const size_t TEST_SIZE = 300 * 1024;
+
+// Nén dữ liệu hỗn hợp (văn bản, ngẫu nhiên, hằng) để có đủ loại block
+static vector<unsigned char> mixedData() {
+    vector<unsigned char> data = makeTestData(TestData::Text, TEST_SIZE / 3, 5);
+    vector<unsigned char> random = makeTestData(TestData::Random, TEST_SIZE / 3, 5);
+    vector<unsigned char> constant = makeTestData(TestData::Constant, TEST_SIZE - 2 * (TEST_SIZE / 3));
+    data.insert(data.end(), random.begin(), random.end());
+    data.insert(data.end(), constant.begin(), constant.end());
+    return data;
+}
+
+static vector<unsigned char> compressSpan(const vector<unsigned char>& raw) {
+    HuffmanBlockCompressor compressor;
+    compressor.setBlockSize(64 * 1024);
+    vector<byte> packed(compressor.maxCompressedSize(raw.size()));
+    size_t packedSize = 0;
+    span<const byte> input(reinterpret_cast<const byte*>(raw.data()), raw.size());
+    if (!compressor.compress(input, packed, packedSize)) return {};
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(packed.data());
+    return vector<unsigned char>(p, p + packedSize);
+}
+
+static bool decompressSpan(const vector<unsigned char>& packed, size_t rawSize) {
+    HuffmanBlockCompressor compressor;
+    vector<byte> restored(rawSize);
+    size_t restoredSize = 0;
+    span<const byte> input(reinterpret_cast<const byte*>(packed.data()), packed.size());
+    return compressor.decompress(input, restored, restoredSize);
+}
+
+// Giải nén / kiểm tra qua đường file đều phải báo lỗi
+static bool fileRejected(const vector<unsigned char>& packed) {
+    string packedPath = testTempPath("corrupt.huff");
+    string outPath = testTempPath("corrupt.out");
+    writeTestFile(packedPath, packed);
+    HuffmanBlockCompressor compressor;
+    bool decompressed, tested;
+    {
+        QuietCout quiet;
+        decompressed = compressor.decompress(packedPath, outPath);
+        tested = compressor.test(packedPath);
+    }
+    removeTestFile(packedPath);
+    removeTestFile(outPath);
+    return !decompressed && !tested;
+}
+
+TEST_CASE(corruptionPayloadByte) {
+    vector<unsigned char> raw = mixedData();
+    vector<unsigned char> packed = compressSpan(raw);
+    CHECK(decompressSpan(packed, raw.size()));
+
+    vector<TestBlockRecord> records;
+    CHECK(listBlockRecords(packed, records));
+    bool seenStored = false, seenConstant = false;
+    for (const TestBlockRecord& r : records) {
+        if (r.type == BLOCK_END) continue;
+        seenStored |= r.type == BLOCK_STORED;
+        seenConstant |= r.type == BLOCK_CONSTANT;
+        // Byte giữa payload và byte cuối payload
+        for (size_t at : {r.offset + HUFB_BLOCK_HEADER_SIZE + r.payloadSize / 2,
+                          r.offset + HUFB_BLOCK_HEADER_SIZE + r.payloadSize - 1}) {
+            vector<unsigned char> bad = packed;
+            bad[at] ^= 0x5A;
+            CHECK(!decompressSpan(bad, raw.size()));
+        }
+    }
+    CHECK(seenStored && seenConstant);
+
+    vector<unsigned char> bad = packed;
+    bad[records[0].offset + HUFB_BLOCK_HEADER_SIZE + 200] ^= 0x01;
+    CHECK(fileRejected(bad));
+}
+
+TEST_CASE(corruptionChecksumsAndHeaders) {
+    vector<unsigned char> raw = mixedData();
+    vector<unsigned char> packed = compressSpan(raw);
+    vector<TestBlockRecord> records;
+    CHECK(listBlockRecords(packed, records));
+
+    // CRC32C của block, CRC của toàn bộ dữ liệu (bản ghi kết thúc), kích thước gốc của block
+    vector<size_t> positions = {records[0].offset + 9, records.back().offset + 9, records[1].offset + 1};
+    // Magic, version, kích thước gốc trong header file
+    positions.insert(positions.end(), {0, 4, 12});
+    for (size_t at : positions) {
+        vector<unsigned char> bad = packed;
+        bad[at] ^= 0x01;
+        CHECK(!decompressSpan(bad, raw.size()));
+        CHECK(fileRejected(bad));
+    }
+}
+
+TEST_CASE(corruptionTruncated) {
+    vector<unsigned char> raw = mixedData();
+    vector<unsigned char> packed = compressSpan(raw);
+    for (size_t keep : {(size_t)0, (size_t)10, HUFB_HEADER_SIZE, packed.size() / 2, packed.size() - 1}) {
+        vector<unsigned char> bad(packed.begin(), packed.begin() + keep);
+        CHECK(!decompressSpan(bad, raw.size()));
+        CHECK(fileRejected(bad));
+    }
+
+    // Buffer đích nhỏ hơn dữ liệu gốc
+    CHECK(!decompressSpan(packed, raw.size() - 1));
+}
@@ -0,0 +1,130 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+// Giải nén song song (--legacy) file định dạng cũ: file do bản đầu tạo ra (tests/data), file của các engine
+// hiện tại, output.huff của chương trình demo, và phát hiện file hỏng
+
+#include "huffmanTest.h"
+#include "../Sampletxtfile/huffmanCompress.h"
+#include "../Sampletxtfile/huffmanCompressPar.h"
+#include "../Sampletxtfile/huffmanDecompressPar.h"
+
+using namespace std;
+
+// Giải nén file nén (đường dẫn) và so với dữ liệu gốc
+static bool legacyRoundTrip(const string& packedPath, const vector<unsigned char>& raw, int threads = 0) {
+    string outPath = testTempPath("legacy.out");
+    HuffmanDecompressorPar decompressor;
+    decompressor.setThreads(threads);
+    bool ok;
+    {
+        QuietCout quiet;
+        ok = decompressor.decompress(packedPath, outPath);
+    }
+    vector<unsigned char> restored;
+    ok = ok && readTestFile(outPath, restored) && restored == raw;
+    removeTestFile(outPath);
+    return ok;
+}
+
+static bool legacyRejected(const vector<unsigned char>& packed) {
+    string packedPath = testTempPath("legacy_bad.huff");
+    writeTestFile(packedPath, packed);
+    HuffmanDecompressorPar decompressor;
+    bool ok;
+    {
+        QuietCout quiet;
+        ok = decompressor.decompress(packedPath, "");
+    }
+    removeTestFile(packedPath);
+    return !ok;
+}
+
+// File của bản đầu: tần suất int32, ký tự duy nhất có mã rỗng (luồng bit trống)
+TEST_CASE(legacyBaselineFiles) {
+    vector<unsigned char> text, one;
+    CHECK(readTestFile(testDataPath("10kB.txt"), text));
+    CHECK(readTestFile(testDataPath("one.txt"), one));
+    for (const char* name : {"baseline_seq_10kB.huff", "baseline_par_10kB.huff"}) {
+        CHECK(legacyRoundTrip(testDataPath(name), text));
+        CHECK(legacyRoundTrip(testDataPath(name), text, 1));
+    }
+    CHECK(legacyRoundTrip(testDataPath("baseline_seq_one.huff"), one));
+
+    // Bit khác 0 trong luồng bit của file 1 ký tự, hoặc sửa 1 byte giữa luồng bit
+    vector<unsigned char> packed;
+    CHECK(readTestFile(testDataPath("baseline_seq_one.huff"), packed));
+    packed.push_back(0x80);
+    CHECK(legacyRejected(packed));
+    CHECK(readTestFile(testDataPath("baseline_seq_10kB.huff"), packed));
+    packed[packed.size() / 2] ^= 0x10;
+    CHECK(legacyRejected(packed));
+}
+
+// output.huff của demo: bản đầu (không có CRC) và bản hiện tại (CRC32C ở cuối)
+TEST_CASE(legacyDemoFiles) {
+    vector<unsigned char> text, one;
+    CHECK(readTestFile(testDataPath("10kB.txt"), text));
+    CHECK(readTestFile(testDataPath("one.txt"), one));
+    CHECK(legacyRoundTrip(testDataPath("baseline_demo_10kB.huff"), text));
+    CHECK(legacyRoundTrip(testDataPath("baseline_demo_one.huff"), one));
+    CHECK(legacyRoundTrip(testDataPath("demo_10kB.huff"), text));
+    CHECK(legacyRoundTrip(testDataPath("demo_10kB.huff"), text, 1));
+
+    vector<unsigned char> packed;
+    CHECK(readTestFile(testDataPath("demo_10kB.huff"), packed));
+    for (size_t at : {(size_t)0, (size_t)3, packed.size() - 1, packed.size() - 100}) {
+        vector<unsigned char> bad = packed;
+        bad[at] ^= 0x01;
+        CHECK(legacyRejected(bad));
+    }
+    vector<unsigned char> truncated(packed.begin(), packed.end() - 5);
+    CHECK(legacyRejected(truncated));
+}
+
+// Cây lệch trái sâu 255 mức, luồng bit 8 bit toàn 0: mã đầu tiên đi quá cuối luồng bit 247 bit.
+// Phần đệm sau luồng bit phải đủ cho lượt đi đó (trước đây đọc ra ngoài buffer).
+TEST_CASE(legacyDeepTreePastEnd) {
+    vector<unsigned char> packed(255, '0');
+    packed.insert(packed.end(), {'1', 255});
+    for (int c = 254; c >= 0; c--) packed.insert(packed.end(), {'1', (unsigned char)c});
+    packed.push_back('|');
+    uint64_t bitLength = 8;
+    const unsigned char* length = reinterpret_cast<const unsigned char*>(&bitLength);
+    packed.insert(packed.end(), length, length + sizeof(bitLength));
+    packed.push_back(0x00);
+    CHECK(packed.size() == 777);
+    CHECK(legacyRejected(packed));
+}
+
+// File của các engine hiện tại: tần suất u64, bảng mẫu của mức Fast, cả 2 cách ghi
+TEST_CASE(legacyCurrentEngines) {
+    string rawPath = testTempPath("legacy.raw");
+    string packedPath = testTempPath("legacy.huff");
+    for (TestData kind : {TestData::Text, TestData::Random, TestData::Constant}) {
+        vector<unsigned char> raw = makeTestData(kind, 300 * 1024, 13);
+        CHECK(writeTestFile(rawPath, raw));
+        {
+            HuffmanCompressor compressor;
+            QuietCout quiet;
+            compressor.compress(rawPath, packedPath);
+        }
+        CHECK(legacyRoundTrip(packedPath, raw));
+
+        for (CompressionLevel level : {CompressionLevel::Exact, CompressionLevel::Fast}) {
+            for (OutputMode output : {OutputMode::Stream, OutputMode::Mmap}) {
+                HuffmanCompressorPar compressor;
+                compressor.setLevel(level);
+                compressor.setOutputMode(output);
+                {
+                    QuietCout quiet;
+                    compressor.compress(rawPath, packedPath);
+                }
+                CHECK(legacyRoundTrip(packedPath, raw));
+            }
+        }
+    }
+    removeTestFile(rawPath);
+    removeTestFile(packedPath);
+}
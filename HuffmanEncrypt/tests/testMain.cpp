@@ -0,0 +1,141 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+// Chạy mọi test (hoặc các test có tên chứa chuỗi truyền vào): HuffmanTests [bo_loc]
+
+#include "huffmanTest.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <process.h>
+#include <stdlib.h>
+#define getpid _getpid
+#define setenv(name, value, overwrite) _putenv_s(name, value)
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifndef HUFFMAN_TEST_DATA_DIR
+#define HUFFMAN_TEST_DATA_DIR "tests/data"
+#endif
+
+static int failures = 0;
+
+vector<TestCase>& testRegistry() {
+    static vector<TestCase> tests;
+    return tests;
+}
+
+void testFailed(const char* file, int line, const char* expr) {
+    cerr << "    " << file << ":" << line << ": CHECK(" << expr << ") that bai" << endl;
+    failures++;
+}
+
+vector<unsigned char> makeTestData(TestData kind, size_t n, uint32_t seed) {
+    static const char* WORDS[] = {"the ", "of ", "and ", "to ", "in ", "is ", "that ", "for ", "it ", "as ",
+                                  "with ", "was ", "on ", "be ", "at ", "by ", "this ", "had ", "not ", "are "};
+    vector<unsigned char> data;
+    data.reserve(n);
+    uint32_t state = seed * 2654435761u + 1;
+    auto next = [&] {
+        state = state * 1103515245u + 12345u;
+        return state >> 8;
+    };
+
+    while (data.size() < n) {
+        switch (kind) {
+            case TestData::Text: {
+                // Độ dài từ 1-9, chữ thường theo tần suất lệch, thỉnh thoảng xuống dòng / dấu câu
+                int len = 1 + next() % 9;
+                for (int k = 0; k < len && data.size() < n; k++) {
+                    uint32_t r = next() % 100;
+                    data.push_back((unsigned char)(r < 60 ? "etaoinshr"[r % 9] : 'a' + r % 26));
+                }
+                if (data.size() < n) data.push_back(next() % 12 == 0 ? '\n' : (next() % 15 == 0 ? ',' : ' '));
+                break;
+            }
+            case TestData::Random:
+                data.push_back((unsigned char)next());
+                break;
+            case TestData::Constant:
+                data.push_back('x');
+                break;
+            case TestData::Words: {
+                const char* w = WORDS[next() % 20];
+                for (; *w && data.size() < n; w++) data.push_back((unsigned char)*w);
+                break;
+            }
+        }
+    }
+    return data;
+}
+
+string testTempPath(const string& name) {
+    filesystem::path dir = filesystem::temp_directory_path();
+    return (dir / ("huffman_test_" + to_string(getpid()) + "_" + name)).string();
+}
+
+void removeTestFile(const string& path) {
+    error_code ec;
+    filesystem::remove(path, ec);
+}
+
+bool writeTestFile(const string& path, const vector<unsigned char>& data) {
+    ofstream out(path, ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()), (streamsize)data.size());
+    return (bool)out;
+}
+
+bool readTestFile(const string& path, vector<unsigned char>& data) {
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    data.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return true;
+}
+
+string testDataPath(const string& name) {
+    return (filesystem::path(HUFFMAN_TEST_DATA_DIR) / name).string();
+}
+
+static uint32_t readU32(const unsigned char* p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+bool listBlockRecords(const vector<unsigned char>& file, vector<TestBlockRecord>& records) {
+    records.clear();
+    if (file.size() < 20 || file[4] != 2) return false;
+    size_t pos = 20;
+    while (pos + 13 <= file.size()) {
+        TestBlockRecord r{file[pos], pos, readU32(&file[pos + 1]), readU32(&file[pos + 5])};
+        records.push_back(r);
+        if (r.type == 0xFF) return pos + 13 == file.size();
+        pos += 13 + (size_t)r.payloadSize;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    string filter = argc > 1 ? argv[1] : "";
+    // Cache mô hình song song của lần chạy test nằm trong thư mục tạm, không ghi vào home của người chạy
+    string tuneCache = testTempPath("tune");
+    setenv("HUFFMAN_TUNE_CACHE", tuneCache.c_str(), 1);
+    int run = 0, failedTests = 0;
+    for (const TestCase& test : testRegistry()) {
+        if (!filter.empty() && string(test.name).find(filter) == string::npos) continue;
+        int before = failures;
+        test.run();
+        run++;
+        bool ok = failures == before;
+        failedTests += !ok;
+        cerr << (ok ? "[ OK ] " : "[FAIL] ") << test.name << endl;
+    }
+    cerr << run - failedTests << " / " << run << " test dat" << endl;
+    for (const char* engine : {"string", "block"}) removeTestFile(tuneCache + "-" + engine);
+    return failedTests == 0 && run > 0 ? 0 : 1;
+}
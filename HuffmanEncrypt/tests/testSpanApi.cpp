@@ -0,0 +1,100 @@
+//
+// Created by dinhd on 12/17/2025.
+//
+
+// API trong bộ nhớ: dùng lại 1 compressor cho nhiều lần gọi, buffer đích thiếu, không in log khi lỗi
+
+#include "huffmanTest.h"
+#include "../Sampletxtfile/huffmanBlockCompressor.h"
+#include <cstring>
+
+using namespace std;
+
+static span<const byte> asBytes(const vector<unsigned char>& v) {
+    return span<const byte>(reinterpret_cast<const byte*>(v.data()), v.size());
+}
+
+TEST_CASE(spanReuseAcrossCalls) {
+    HuffmanBlockCompressor compressor;
+    vector<byte> packed, restored;
+    // Kích thước tăng rồi giảm: buffer nội bộ được dùng lại, kết quả không phụ thuộc lần gọi trước
+    for (size_t n : {(size_t)500 * 1024, (size_t)1000, (size_t)200 * 1024, (size_t)64 * 1024}) {
+        vector<unsigned char> raw = makeTestData(TestData::Words, n, (uint32_t)n);
+        packed.resize(compressor.maxCompressedSize(n));
+        size_t packedSize = 0;
+        CHECK(compressor.compress(asBytes(raw), packed, packedSize));
+
+        restored.assign(n, byte{0});
+        size_t restoredSize = 0;
+        CHECK(compressor.decompress(span<const byte>(packed.data(), packedSize), restored, restoredSize));
+        CHECK(restoredSize == n && memcmp(restored.data(), raw.data(), n) == 0);
+    }
+}
+
+TEST_CASE(spanOutputTooSmall) {
+    HuffmanBlockCompressor compressor;
+    vector<unsigned char> raw = makeTestData(TestData::Random, 200 * 1024);
+    vector<byte> packed(compressor.maxCompressedSize(raw.size()));
+    size_t packedSize = 0;
+    CHECK(compressor.compress(asBytes(raw), packed, packedSize));
+
+    // Buffer nén thiếu 1 byte (dữ liệu ngẫu nhiên: gần đúng bằng cận trên)
+    vector<byte> small(packedSize - 1);
+    size_t size = 0;
+    CHECK(!compressor.compress(asBytes(raw), small, size));
+
+    vector<byte> restored(raw.size() - 1);
+    CHECK(!compressor.decompress(span<const byte>(packed.data(), packedSize), restored, size));
+}
+
+TEST_CASE(spanHeaderValidation) {
+    HuffmanBlockCompressor compressor;
+    vector<unsigned char> raw = makeTestData(TestData::Text, 10000);
+    vector<byte> packed(compressor.maxCompressedSize(raw.size()));
+    size_t packedSize = 0;
+    CHECK(compressor.compress(asBytes(raw), packed, packedSize));
+    packed.resize(packedSize);
+
+    uint64_t size = 0;
+    CHECK(HuffmanBlockCompressor::decompressedSize(packed, size) && size == raw.size());
+    for (uint8_t version : {(uint8_t)0, (uint8_t)3, (uint8_t)0xFF}) {
+        vector<byte> bad = packed;
+        bad[4] = byte{version};
+        CHECK(!HuffmanBlockCompressor::decompressedSize(bad, size));
+    }
+    vector<byte> badMagic = packed;
+    badMagic[0] = byte{'X'};
+    CHECK(!HuffmanBlockCompressor::decompressedSize(badMagic, size));
+    CHECK(!HuffmanBlockCompressor::decompressedSize(span<const byte>(packed.data(), 19), size));
+}
+
+// Lỗi của API trong bộ nhớ chỉ báo bằng giá trị trả về, không ghi ra cout / cerr
+TEST_CASE(spanErrorsAreSilent) {
+    HuffmanBlockCompressor compressor;
+    vector<unsigned char> raw = makeTestData(TestData::Text, 300 * 1024);
+    vector<byte> packed(compressor.maxCompressedSize(raw.size()));
+    size_t packedSize = 0;
+    CHECK(compressor.compress(asBytes(raw), packed, packedSize));
+    packed.resize(packedSize);
+
+    ostringstream captured;
+    streambuf* savedOut = cout.rdbuf(captured.rdbuf());
+    streambuf* savedErr = cerr.rdbuf(captured.rdbuf());
+    vector<byte> restored(raw.size());
+    size_t size = 0;
+    vector<byte> bad = packed;
+    bad[4] = byte{9};                                                       // Sai version
+    bool badVersion = compressor.decompress(bad, restored, size);
+    bool truncated = compressor.decompress(span<const byte>(packed.data(), packedSize - 5), restored, size);
+    bad = packed;
+    bad[HUFB_HEADER_SIZE + 5] ^= byte{0x40};                                // Sai kích thước payload
+    bool badRecord = compressor.decompress(bad, restored, size);
+    bad = packed;
+    bad[packedSize / 2] ^= byte{0x40};                                      // Sai dữ liệu
+    bool badPayload = compressor.decompress(bad, restored, size);
+    cout.rdbuf(savedOut);
+    cerr.rdbuf(savedErr);
+
+    CHECK(!badVersion && !truncated && !badRecord && !badPayload);
+    CHECK(captured.str().empty());
+}
@@ -9,16 +9,17 @@
 #include <cstring>
 #include <iomanip>
 #include <omp.h>
+#include "HuffmanEncrypt/Sampletxtfile/huffmanTuning.h"
 
 using namespace std;
 
 // Cấu trúc Node cho cây Huffman
 struct HuffmanNode {
     char ch;
-    int freq;
+    uint64_t freq; // 64-bit: input > 2 GB không tràn tần suất
     HuffmanNode *left, *right;
 
-    HuffmanNode(char c, int f) : ch(c), freq(f), left(nullptr), right(nullptr) {}
+    HuffmanNode(char c, uint64_t f) : ch(c), freq(f), left(nullptr), right(nullptr) {}
 };
 
 // So sánh để dùng trong priority_queue (min-heap)
@@ -28,6 +29,24 @@ struct Compare {
     }
 };
 
+// CRC32C (đa thức Castagnoli) theo từng byte, dùng để kiểm tra toàn vẹn dữ liệu sau giải nén
+uint32_t crc32c(const string& data) {
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t c = b;
+            for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0x82F63B78 & (0u - (c & 1)));
+            table[b] = c;
+        }
+        ready = true;
+    }
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (unsigned char ch : data) crc = (crc >> 8) ^ table[(crc ^ ch) & 0xFF];
+    return ~crc;
+}
+
 // Đọc file
 string readFile(const string& filename) {
     double start_time = omp_get_wtime();
@@ -61,21 +80,21 @@ bool writeFile(const string& filename, const string& content) {
 }
 
 // Đếm tần suất ký tự với OpenMP
-map<char, int> countFrequency(const string& data, int num_threads) {
+map<char, uint64_t> countFrequency(const string& data, int num_threads) {
     double start_time = omp_get_wtime();
 
-    map<char, int> freq;
-    int data_size = data.size();
+    map<char, uint64_t> freq;
+    long long data_size = (long long)data.size();
 
     // Tạo mảng local cho mỗi thread
-    vector<map<char, int>> local_freq(num_threads);
+    vector<map<char, uint64_t>> local_freq(num_threads);
 
     #pragma omp parallel num_threads(num_threads)
     {
         int thread_id = omp_get_thread_num();
 
         #pragma omp for schedule(static)
-        for (int i = 0; i < data_size; i++) {
+        for (long long i = 0; i < data_size; i++) {
             local_freq[thread_id][data[i]]++;
         }
     }
@@ -94,7 +113,7 @@ map<char, int> countFrequency(const string& data, int num_threads) {
 }
 
 // Xây dựng cây Huffman
-HuffmanNode* buildHuffmanTree(map<char, int>& freq) {
+HuffmanNode* buildHuffmanTree(map<char, uint64_t>& freq) {
     double start_time = omp_get_wtime();
 
     priority_queue<HuffmanNode*, vector<HuffmanNode*>, Compare> pq;
@@ -147,22 +166,40 @@ void buildCodes(HuffmanNode* root, string code, map<char, string>& huffmanCodes)
 }
 
 // Mã hóa dữ liệu
-string encodeData(const string& data, map<char, string>& huffmanCodes, int num_threads) {
+// freq: tần suất đã đếm ở countFrequency (dùng để tính tổng số bit, không đếm lại input)
+string encodeData(const string& data, map<char, string>& huffmanCodes, const map<char, uint64_t>& freq,
+                  int num_threads) {
     double start_time = omp_get_wtime();
 
-    int data_size = data.size();
-    vector<string> encoded_parts(data_size);
+    size_t data_size = data.size();
 
-    // Mã hóa song song
-    #pragma omp parallel for num_threads(num_threads) schedule(static)
-    for (int i = 0; i < data_size; i++) {
-        encoded_parts[i] = huffmanCodes[data[i]];
+    // Bảng mã dạng mảng (tra cứu O(1), an toàn khi đọc đồng thời) và tổng số bit để cấp phát đúng 1 lần.
+    // Trước đây mỗi byte input có 1 string riêng (vector<string>(data_size)): vài chục byte heap / byte input.
+    string codes[256];
+    uint64_t total_bits = 0;
+    for (auto& pair : huffmanCodes) codes[(unsigned char)pair.first] = pair.second;
+    for (auto& pair : freq) total_bits += pair.second * codes[(unsigned char)pair.first].size();
+
+    // Mỗi luồng mã hóa 1 đoạn liên tiếp vào chuỗi cục bộ, sau đó ghép theo thứ tự
+    vector<string> encoded_parts(num_threads);
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int thread_id = omp_get_thread_num();
+        size_t begin = data_size * thread_id / num_threads;
+        size_t end = data_size * (thread_id + 1) / num_threads;
+
+        string& local = encoded_parts[thread_id];
+        for (size_t i = begin; i < end; i++) {
+            local += codes[(unsigned char)data[i]];
+        }
     }
 
-    // Ghép các phần lại
-    string encoded = "";
-    for (const auto& part : encoded_parts) {
+    string encoded;
+    encoded.reserve(total_bits);
+    for (auto& part : encoded_parts) {
         encoded += part;
+        string().swap(part); // Trả bộ nhớ ngay, không giữ cả 2 bản cùng lúc
     }
 
     double end_time = omp_get_wtime();
@@ -175,8 +212,8 @@ string encodeData(const string& data, map<char, string>& huffmanCodes, int num_t
 string bitStringToBytes(const string& bitString) {
     string result;
 
-    // Lưu độ dài chuỗi bit ban đầu (8 bytes)
-    size_t bitLength = bitString.size();
+    // Lưu độ dài chuỗi bit ban đầu (8 bytes, cố định kể cả trên bản build 32-bit)
+    uint64_t bitLength = bitString.size();
     result.append(reinterpret_cast<const char*>(&bitLength), sizeof(bitLength));
 
     // Chuyển từng 8 bit thành 1 byte
@@ -193,14 +230,14 @@ string bitStringToBytes(const string& bitString) {
 
 // Chuyển bytes thành chuỗi bit
 string bytesToBitString(const string& bytes) {
-    if (bytes.size() < sizeof(size_t)) return "";
+    if (bytes.size() < sizeof(uint64_t)) return "";
 
     // Đọc độ dài chuỗi bit ban đầu
-    size_t bitLength;
+    uint64_t bitLength;
     memcpy(&bitLength, bytes.data(), sizeof(bitLength));
 
     string bitString = "";
-    for (size_t i = sizeof(size_t); i < bytes.size(); i++) {
+    for (size_t i = sizeof(uint64_t); i < bytes.size(); i++) {
         bitset<8> bits(static_cast<unsigned char>(bytes[i]));
         bitString += bits.to_string();
     }
@@ -222,6 +259,7 @@ string decodeData(const string& encodedBits, HuffmanNode* root) {
         } else {
             current = current->right;
         }
+        if (!current) break; // Cây hỏng (deserializeTree trả về nullptr)
 
         // Đến node lá
         if (!current->left && !current->right) {
@@ -250,22 +288,24 @@ void serializeTree(HuffmanNode* root, string& result) {
     }
 }
 
-// Deserialize cây Huffman từ chuỗi
-HuffmanNode* deserializeTree(const string& data, int& index) {
-    if (index >= data.size()) return nullptr;
+// Deserialize cây Huffman từ chuỗi (cây của tối đa 256 ký tự không sâu quá 255 mức: sâu hơn là dữ liệu hỏng)
+HuffmanNode* deserializeTree(const string& data, size_t& index, int depth = 0) {
+    if (index >= data.size() || depth > 256) return nullptr;
 
     if (data[index] == '1') {
         index++;
+        if (index >= data.size()) return nullptr; // Cây bị cắt cụt: thiếu ký tự của lá
         char ch = data[index];
         index++;
         return new HuffmanNode(ch, 0);
-    } else {
+    } else if (data[index] == '0') {
         index++;
         HuffmanNode* node = new HuffmanNode('\0', 0);
-        node->left = deserializeTree(data, index);
-        node->right = deserializeTree(data, index);
+        node->left = deserializeTree(data, index, depth + 1);
+        node->right = deserializeTree(data, index, depth + 1);
         return node;
     }
+    return nullptr; // Nhánh rỗng (cây 1 ký tự chỉ có con trái): không tiêu thụ byte nào
 }
 
 // Giải phóng bộ nhớ cây
@@ -276,6 +316,49 @@ void deleteTree(HuffmanNode* root) {
     delete root;
 }
 
+// Tách file nén: [cây][|][u64 số bit][dữ liệu][u32 CRC32C]. CRC nằm ở cuối (trailer) nên bản đọc cũ
+// vẫn đọc được (dữ liệu bị cắt theo số bit, 4 byte thừa bị bỏ qua); file cũ không có trailer thì
+// hasChecksum = false. Cây được đọc theo cấu trúc nên ký tự '|' trong cây không làm tách sai.
+// Bản đầu ghi số bit bằng size_t: bản build 32-bit của nó có trường độ dài 4 byte, nhận ra theo kích thước.
+bool parseCompressedFile(const string& file, HuffmanNode*& root, string& encodedBits, bool& hasChecksum,
+                         uint32_t& checksum) {
+    size_t index = 0;
+    root = deserializeTree(file, index);
+    if (!root || index >= file.size() || file[index] != '|') {
+        deleteTree(root);
+        root = nullptr;
+        return false;
+    }
+
+    string body = file.substr(index + 1);
+    for (size_t lengthSize : {sizeof(uint64_t), sizeof(uint32_t)}) {
+        if (body.size() < lengthSize) continue;
+        uint64_t bitLength = 0;
+        if (lengthSize == sizeof(uint64_t)) {
+            memcpy(&bitLength, body.data(), sizeof(uint64_t));
+        } else {
+            uint32_t bitLength32;
+            memcpy(&bitLength32, body.data(), sizeof(uint32_t));
+            bitLength = bitLength32;
+        }
+        if (bitLength > (uint64_t)body.size() * 8) continue;
+
+        uint64_t withoutTrailer = lengthSize + bitLength / 8 + (bitLength % 8 != 0);
+        hasChecksum = body.size() == withoutTrailer + sizeof(checksum);
+        if (!hasChecksum && body.size() != withoutTrailer) continue;
+        if (hasChecksum) memcpy(&checksum, body.data() + withoutTrailer, sizeof(checksum));
+
+        // bytesToBitString đọc độ dài u64 ở đầu
+        string bytes(reinterpret_cast<const char*>(&bitLength), sizeof(bitLength));
+        bytes.append(body, lengthSize, withoutTrailer - lengthSize);
+        encodedBits = bytesToBitString(bytes);
+        return true;
+    }
+    deleteTree(root);
+    root = nullptr;
+    return false;
+}
+
 // Draw line separator
 void printLine(char symbol = '=', int length = 70) {
     cout << string(length, symbol) << endl;
@@ -304,13 +387,29 @@ string formatSize(size_t bytes) {
     return to_string(bytes / (1024 * 1024)) + " MB";
 }
 
+// Kernel của chương trình này cho mô hình chi phí song song: đếm tần suất bằng map + nối mã dạng chuỗi
+// như countFrequency / encodeData. Số luồng được chọn theo mô hình đo trên máy (file nhỏ: chạy tuần tự
+// vì chi phí fork/join và cấp phát cho từng luồng lớn hơn phần tiết kiệm được).
+static size_t demoTuneKernel(const unsigned char* data, size_t n) {
+    map<char, uint64_t> freq;
+    for (size_t i = 0; i < n; i++) freq[(char)data[i]]++;
+    string codes[256];
+    for (int s = 0; s < 256; s++) codes[s] = string(4 + s % 3, '0' + s % 2);
+    string encoded;
+    for (size_t i = 0; i < n; i++) encoded += codes[data[i]];
+    return encoded.size() + freq.size();
+}
+
+static const TuneEngine DEMO_TUNE_ENGINE = {"demo", demoTuneKernel};
+
 int main() {
-    // Cấu hình
-    int num_threads = 4;
+    // Mô hình song song đã đo được dùng lại giữa các lần chạy
+    ParallelTuner::enableDiskCache();
+    // Cấu hình: số luồng được chọn sau khi biết kích thước input
+    int num_threads = omp_get_max_threads();
 
     // Header chính
     printHeader("HUFFMAN COMPRESSION PROGRAM");
-    cout << "\n  [*] OpenMP Threads: " << num_threads << endl;
     cout << "  [*] Algorithm: Huffman Coding" << endl;
     cout << "  [*] Mode: Parallel Processing" << endl;
 
@@ -337,12 +436,19 @@ int main() {
 
     cout << "  [+] Original size: " << formatSize(data.size()) << endl;
 
+    // Checksum được lưu trong file nén, nên không cần giữ bản gốc để so sánh sau khi giải nén
+    uint32_t checksum = crc32c(data);
+    size_t original_size = data.size();
+
+    num_threads = ParallelTuner::instance(DEMO_TUNE_ENGINE).plan(data.size()).threads;
+    cout << "  [*] OpenMP Threads: " << num_threads << endl;
+
     // ===== BƯỚC 2: NÉN DỮ LIỆU =====
     printSection("STEP 2: COMPRESSION");
 
     // Đếm tần suất
     cout << "\n  [>] Counting character frequencies..." << endl;
-    map<char, int> freq = countFrequency(data, num_threads);
+    map<char, uint64_t> freq = countFrequency(data, num_threads);
     cout << "  [+] Unique characters: " << freq.size() << endl;
 
     // Xây dựng cây Huffman
@@ -371,7 +477,7 @@ int main() {
 
     // Mã hóa
     cout << "\n  [>] Encoding data..." << endl;
-    string encodedBits = encodeData(data, huffmanCodes, num_threads);
+    string encodedBits = encodeData(data, huffmanCodes, freq, num_threads);
     size_t compressedSize = encodedBits.size() / 8;
     double ratio = (1.0 - (double)compressedSize / data.size()) * 100;
 
@@ -382,7 +488,12 @@ int main() {
     // Serialize cây và dữ liệu nén
     string treeData = "";
     serializeTree(root, treeData);
-    string compressedData = treeData + "|" + bitStringToBytes(encodedBits);
+    string compressedData = treeData + "|" + bitStringToBytes(encodedBits) +
+                            string(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+    // Giải phóng dữ liệu gốc và chuỗi bit trước khi giải nén
+    string().swap(data);
+    string().swap(encodedBits);
 
     // Ghi file nén
     cout << "\n  [>] Saving compressed file..." << endl;
@@ -396,18 +507,18 @@ int main() {
     cout << "\n  [>] Reading compressed file..." << endl;
     string compressedRead = readFile("output.huff");
 
-    // Tách cây và dữ liệu
-    size_t delimiter = compressedRead.find('|');
-    string treeDataRead = compressedRead.substr(0, delimiter);
-    string encodedDataRead = compressedRead.substr(delimiter + 1);
-
-    // Deserialize cây
+    // Tách cây, dữ liệu và checksum (deserialize cây, chuyển bytes về bits)
     cout << "  [>] Rebuilding Huffman tree..." << endl;
-    int index = 0;
-    HuffmanNode* rootDecoded = deserializeTree(treeDataRead, index);
-
-    // Chuyển bytes về bits
-    string encodedBitsRead = bytesToBitString(encodedDataRead);
+    HuffmanNode* rootDecoded = nullptr;
+    string encodedBitsRead;
+    bool hasChecksum = false;
+    uint32_t checksumRead = 0;
+    if (!parseCompressedFile(compressedRead, rootDecoded, encodedBitsRead, hasChecksum, checksumRead)) {
+        cout << "\n  [ERROR] Compressed file is corrupted!" << endl;
+        deleteTree(root);
+        printLine('=');
+        return 1;
+    }
 
     // Giải mã
     cout << "  [>] Decoding data..." << endl;
@@ -417,7 +528,7 @@ int main() {
 
     // Kiểm tra tính đúng đắn
     cout << "\n  [>] Verifying integrity..." << endl;
-    if (decodedData == data) {
+    if (decodedData.size() == original_size && (!hasChecksum || crc32c(decodedData) == checksumRead)) {
         cout << "  [SUCCESS] Data integrity verified! ✓" << endl;
     } else {
         cout << "  [ERROR] Data mismatch! ✗" << endl;
@@ -429,7 +540,7 @@ int main() {
 
     // Hiển thị một phần nội dung
     printSection("PREVIEW (First 100 characters)");
-    string preview = decodedData.substr(0, min(100, (int)decodedData.size()));
+    string preview = decodedData.substr(0, 100);
     cout << "  " << preview;
     if (decodedData.size() > 100) cout << "...";
     cout << endl;